@@ -0,0 +1,138 @@
+#include "array.h"
+
+#include <vector>
+
+static int arrayTestLive = 0;
+
+struct arrayTestObject_t
+{
+    std::vector<int> values;
+
+    arrayTestObject_t() { ++arrayTestLive; }
+    arrayTestObject_t( const int value ) : values( 1, value ) { ++arrayTestLive; }
+    arrayTestObject_t( const arrayTestObject_t& rhs ) : values( rhs.values ) { ++arrayTestLive; }
+    arrayTestObject_t( arrayTestObject_t&& rhs ) noexcept : values( std::move( rhs.values ) ) { ++arrayTestLive; }
+    ~arrayTestObject_t() { --arrayTestLive; }
+
+    arrayTestObject_t& operator=( const arrayTestObject_t& ) = default;
+    arrayTestObject_t& operator=( arrayTestObject_t&& ) = default;
+
+    inline int Value() const
+    {
+        return values.empty() ? -1 : values[ 0 ];
+    }
+};
+
+
+void TestArray()
+{
+    using testArray_t = Array<arrayTestObject_t, 8>;
+
+    // The trap element lives for the whole run, count from after it exists
+    {
+        testArray_t empty;
+        empty.Resize( 0 );
+    }
+    const int baseLive = arrayTestLive;
+
+    // --- Append and Emplace ---
+    {
+        testArray_t a;
+        arrayTestObject_t value( 1 );
+        assert( a.Append( value ) );
+        assert( a.Append( arrayTestObject_t( 2 ) ) );
+        assert( a.Emplace( 3 )->Value() == 3 );
+        assert( a.Count() == 3 );
+        assert( arrayTestLive == baseLive + 4 );
+        assert( ( a[ 0 ].Value() == 1 ) && ( a[ 1 ].Value() == 2 ) && ( a[ 2 ].Value() == 3 ) );
+
+        const arrayTestObject_t range[ 2 ] = { 4, 5 };
+        assert( a.Append( range, 2 ) );
+        assert( a.Count() == 5 );
+        assert( a[ 4 ].Value() == 5 );
+        assert( arrayTestLive == baseLive + 8 );
+    }
+    assert( arrayTestLive == baseLive );
+
+    // --- Resize, Grow, Shrink ---
+    {
+        testArray_t a;
+        a.Emplace( 7 );
+        assert( a.Grow( 2 ).Value() == -1 );
+        assert( a.Count() == 3 );
+        assert( arrayTestLive == baseLive + 3 );
+
+        assert( a.Shrink( 2 ).Value() == 7 );
+        assert( a.Count() == 1 );
+        assert( arrayTestLive == baseLive + 1 );
+
+        // Growing past the capacity clamps at N
+        a.Resize( 20 );
+        assert( a.Count() == a.Capacity() );
+        assert( arrayTestLive == baseLive + 8 );
+        a.Grow( 1 );
+        assert( a.Count() == 8 );
+        assert( arrayTestLive == baseLive + 8 );
+
+        // Emptying returns the trap, never a destroyed slot
+        arrayTestObject_t& last = a.Resize( 0 );
+        assert( &last != a.Ptr() );
+        assert( a.Count() == 0 );
+        assert( arrayTestLive == baseLive );
+
+        a.Emplace( 9 );
+        assert( &a.Shrink( 5 ) != a.Ptr() );
+        assert( a.Count() == 0 );
+        assert( arrayTestLive == baseLive );
+    }
+    assert( arrayTestLive == baseLive );
+
+    // --- Copy and move ---
+    {
+        testArray_t a;
+        for ( int i = 0; i < 5; ++i ) {
+            a.Emplace( i );
+        }
+
+        testArray_t copy( a );
+        assert( copy.Count() == 5 );
+        assert( copy[ 4 ].Value() == 4 );
+        assert( arrayTestLive == baseLive + 10 );
+
+        testArray_t moved( std::move( copy ) );
+        assert( copy.Count() == 0 );
+        assert( moved.Count() == 5 );
+        assert( moved[ 2 ].Value() == 2 );
+        assert( arrayTestLive == baseLive + 10 );
+
+        testArray_t assigned;
+        assigned.Emplace( 100 );
+        assigned = a;
+        assert( assigned.Count() == 5 );
+        assert( assigned[ 0 ].Value() == 0 );
+        assert( arrayTestLive == baseLive + 15 );
+
+        assigned = std::move( moved );
+        assert( moved.Count() == 0 );
+        assert( assigned[ 3 ].Value() == 3 );
+        assert( arrayTestLive == baseLive + 10 );
+
+        const testArray_t& self = assigned;
+        assigned = self;
+        assert( assigned.Count() == 5 );
+        assert( arrayTestLive == baseLive + 10 );
+    }
+    assert( arrayTestLive == baseLive );
+
+    // --- Trivial elements ---
+    {
+        Array<uint32_t, 4> a;
+        const uint32_t values[ 3 ] = { 1, 2, 3 };
+        assert( a.Append( values, 3 ) );
+        a.Grow( 3 );
+        assert( a.Count() == 4 );
+
+        Array<uint32_t, 4> copy( a );
+        assert( copy[ 2 ] == 3 );
+    }
+}
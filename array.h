@@ -1,27 +1,148 @@
 #pragma once
 #include <assert.h>
 #include <cstdint>
+#include <new>
+#include <string.h>
+#include <type_traits>
+#include <utility>
 
+void TestArray();
+
+// Fixed-capacity array. Storage is left uninitialized and elements are only
+// constructed while they are inside [0, Count())
 template<class T, uint32_t N>
 class Array
 {
 private:
-	T			elements[N];
-	T			trap;
-	uint32_t	count;
+	alignas( T ) uint8_t	storage[ N * sizeof( T ) ];
+	uint32_t				count;
+
+	static constexpr bool IsTrivial = std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>;
+
+	// Raw storage for an element, to construct into
+	inline T* Slot( const uint32_t index )
+	{
+		return reinterpret_cast<T*>( storage ) + index;
+	}
+
+	inline const T* Slot( const uint32_t index ) const
+	{
+		return reinterpret_cast<const T*>( storage ) + index;
+	}
+
+	// A constructed element, only valid inside [0, Count())
+	inline T* Element( const uint32_t index )
+	{
+		return std::launder( Slot( index ) );
+	}
+
+	inline const T* Element( const uint32_t index ) const
+	{
+		return std::launder( Slot( index ) );
+	}
+
+	static inline T& Trap()
+	{
+		static T trap;
+		return trap;
+	}
+
+	inline void ConstructRange( const uint32_t first, const uint32_t last )
+	{
+		for ( uint32_t i = first; i < last; ++i ) {
+			new ( Slot( i ) ) T;
+		}
+	}
+
+	inline void DestroyRange( const uint32_t first, const uint32_t last )
+	{
+		if constexpr ( std::is_trivially_destructible_v<T> == false )
+		{
+			for ( uint32_t i = first; i < last; ++i ) {
+				Element( i )->~T();
+			}
+		}
+	}
+
+	inline void CopyFrom( const Array& rhs )
+	{
+		if constexpr ( IsTrivial ) {
+			memcpy( storage, rhs.storage, rhs.count * sizeof( T ) );
+		} else {
+			for ( uint32_t i = 0; i < rhs.count; ++i ) {
+				new ( Slot( i ) ) T( *rhs.Element( i ) );
+			}
+		}
+		count = rhs.count;
+	}
+
+	inline void MoveFrom( Array& rhs )
+	{
+		if constexpr ( IsTrivial ) {
+			memcpy( storage, rhs.storage, rhs.count * sizeof( T ) );
+		} else {
+			for ( uint32_t i = 0; i < rhs.count; ++i ) {
+				new ( Slot( i ) ) T( std::move( *rhs.Element( i ) ) );
+			}
+		}
+		count = rhs.count;
+		rhs.Reset();
+	}
+
+	// Empty arrays have no last element, hand back the trap rather than unconstructed storage
+	inline T& Last()
+	{
+		return ( count == 0 ) ? Trap() : *Element( count - 1 );
+	}
+
 public:
 
 	Array() : count( 0 )
 	{}
 
+	Array( const Array& rhs ) : count( 0 )
+	{
+		CopyFrom( rhs );
+	}
+
+	Array( Array&& rhs ) noexcept : count( 0 )
+	{
+		MoveFrom( rhs );
+	}
+
+	~Array()
+	{
+		Reset();
+	}
+
+	Array& operator=( const Array& rhs )
+	{
+		if ( this != &rhs )
+		{
+			Reset();
+			CopyFrom( rhs );
+		}
+		return *this;
+	}
+
+	Array& operator=( Array&& rhs ) noexcept
+	{
+		if ( this != &rhs )
+		{
+			Reset();
+			MoveFrom( rhs );
+		}
+		return *this;
+	}
+
 	inline T& operator[]( uint32_t index )
 	{
 		if ( index >= Count() )
 		{
 			assert( 0 );
-			return trap;
+			return Trap();
 		}
-		return elements[ index ];
+		return *Element( index );
 	}
 
 
@@ -30,14 +151,15 @@ public:
 		if ( index >= Count() )
 		{
 			assert( 0 );
-			return trap;
+			return Trap();
 		}
-		return elements[ index ];
+		return *Element( index );
 	}
 
 
 	inline void Reset()
 	{
+		DestroyRange( 0, count );
 		count = 0;
 	}
 
@@ -47,51 +169,86 @@ public:
 		if( newCount > N ) {
 			newCount = N;
 		}
+		if ( newCount > count ) {
+			ConstructRange( count, newCount );
+		} else {
+			DestroyRange( newCount, count );
+		}
 		count = newCount;
-		return ( count == 0 ) ? elements[ 0 ] : elements[ count - 1 ];
+		return Last();
 	}
 
 
 	inline T& Grow( const uint32_t addCount )
 	{
-		uint32_t newCount = addCount + count;
-		if ( newCount > N ) {
-			newCount = N;
-		}
-		count = newCount;
-		return ( count == 0 ) ? elements[ 0 ] : elements[ count - 1 ];
+		return Resize( addCount + count );
 	}
 
 
 	inline T& Shrink( const uint32_t subCount )
 	{
-		if ( subCount >= count ) {
-			count = 0;
-		} else {
-			count -= subCount;
-		}
-		return ( count == 0 ) ? elements[ 0 ] : elements[ count - 1 ];
+		return Resize( ( subCount >= count ) ? 0 : ( count - subCount ) );
 	}
 
 
 	inline bool Append( const T& element )
 	{
-		const uint32_t newCount = ( count + 1 );
-		if ( newCount <= N )
+		return ( Emplace( element ) != nullptr );
+	}
+
+
+	inline bool Append( T&& element )
+	{
+		return ( Emplace( std::move( element ) ) != nullptr );
+	}
+
+
+	// Appends a range of elements, all or nothing
+	inline bool Append( const T* elements, const uint32_t elementCount )
+	{
+		if ( elementCount > ( N - count ) )
 		{
-			elements[ newCount - 1 ] = element;
-			count = newCount;
-			return true;
-		} else {
 			assert( 0 );
 			return false;
 		}
+
+		if constexpr ( IsTrivial ) {
+			memcpy( Slot( count ), elements, elementCount * sizeof( T ) );
+		} else {
+			for ( uint32_t i = 0; i < elementCount; ++i ) {
+				new ( Slot( count + i ) ) T( elements[ i ] );
+			}
+		}
+		count += elementCount;
+		return true;
+	}
+
+
+	// Constructs a new element in place, returns nullptr when full
+	template<typename... Args>
+	inline T* Emplace( Args&&... args )
+	{
+		if ( count >= N )
+		{
+			assert( 0 );
+			return nullptr;
+		}
+
+		T* element = new ( Slot( count ) ) T( std::forward<Args>( args )... );
+		++count;
+		return element;
 	}
 
 
 	inline T* Ptr()
 	{
-		return &elements[ 0 ];
+		return ( count == 0 ) ? Slot( 0 ) : Element( 0 );
+	}
+
+
+	inline const T* Ptr() const
+	{
+		return ( count == 0 ) ? Slot( 0 ) : Element( 0 );
 	}
 
 
@@ -105,4 +262,4 @@ public:
 	{
 		return N;
 	}
-};
\ No newline at end of file
+};
@@ -1,5 +1,10 @@
 #include "bitArray.h"
 
+#include <algorithm>
+#include <string.h>
+
+#include "serializer.h"
+
 namespace SysCore
 {
 void BitArray::Reset()
@@ -90,6 +95,327 @@ bool BitArray::IsSet( const uint32_t element ) const
 }
 
 
+static inline uint64_t RangeMask( const uint32_t lo, const uint32_t hi )
+{
+	const uint64_t hiMask = ( hi >= 64 ) ? ~uint64_t( 0 ) : ( ( uint64_t( 1 ) << hi ) - 1 );
+	const uint64_t loMask = ( uint64_t( 1 ) << lo ) - 1;
+	return hiMask & ~loMask;
+}
+
+
+// Visits each word overlapped by [first, end) with the mask of the covered bits
+template<typename Func>
+static inline void ForEachRangeWord( const uint64_t first, const uint64_t end, Func&& func )
+{
+	const uint32_t bitsPerWord = 64;
+	uint64_t bit = first;
+	while ( bit < end )
+	{
+		const uint32_t wordIx = static_cast<uint32_t>( bit / bitsPerWord );
+		const uint32_t lo = static_cast<uint32_t>( bit % bitsPerWord );
+		const uint32_t hi = static_cast<uint32_t>( std::min<uint64_t>( bitsPerWord, lo + ( end - bit ) ) );
+		if ( func( wordIx, RangeMask( lo, hi ) ) == false ) {
+			return;
+		}
+		bit += ( hi - lo );
+	}
+}
+
+
+void BitArray::SetRange( const uint32_t first, const uint32_t count )
+{
+	if ( count == 0 ) {
+		return;
+	}
+
+	const uint64_t end = static_cast<uint64_t>( first ) + count;
+	const uint32_t lastElementIx = static_cast<uint32_t>( ( end - 1 ) / BitsPerElement );
+	if ( lastElementIx >= static_cast<uint32_t>( bits.size() ) )
+	{
+		bits.resize( lastElementIx + 1 );
+	}
+
+	ForEachRangeWord( first, end, [&]( const uint32_t wordIx, const ElementType mask ) {
+		bits[ wordIx ] |= mask;
+		return true;
+	} );
+}
+
+
+void BitArray::ClearRange( const uint32_t first, const uint32_t count )
+{
+	const uint64_t end = std::min<uint64_t>( static_cast<uint64_t>( first ) + count, Size() );
+
+	ForEachRangeWord( first, end, [&]( const uint32_t wordIx, const ElementType mask ) {
+		bits[ wordIx ] &= ~mask;
+		return true;
+	} );
+}
+
+
+uint32_t BitArray::CountRange( const uint32_t first, const uint32_t count ) const
+{
+	const uint64_t end = std::min<uint64_t>( static_cast<uint64_t>( first ) + count, Size() );
+
+	uint32_t setCount = 0;
+	ForEachRangeWord( first, end, [&]( const uint32_t wordIx, const ElementType mask ) {
+		setCount += SysCore::Popcount( bits[ wordIx ] & mask );
+		return true;
+	} );
+	return setCount;
+}
+
+
+bool BitArray::AllSetInRange( const uint32_t first, const uint32_t count ) const
+{
+	const uint64_t end = static_cast<uint64_t>( first ) + count;
+	if ( end > Size() ) {
+		return ( count == 0 );
+	}
+
+	bool allSet = true;
+	ForEachRangeWord( first, end, [&]( const uint32_t wordIx, const ElementType mask ) {
+		allSet = ( ( bits[ wordIx ] & mask ) == mask );
+		return allSet;
+	} );
+	return allSet;
+}
+
+
+bool BitArray::AnySetInRange( const uint32_t first, const uint32_t count ) const
+{
+	const uint64_t end = std::min<uint64_t>( static_cast<uint64_t>( first ) + count, Size() );
+
+	bool anySet = false;
+	ForEachRangeWord( first, end, [&]( const uint32_t wordIx, const ElementType mask ) {
+		anySet = ( ( bits[ wordIx ] & mask ) != 0 );
+		return ( anySet == false );
+	} );
+	return anySet;
+}
+
+
+bool BitArray::FindClearRun( const uint32_t count, uint32_t& outFirst ) const
+{
+	if ( count == 0 )
+	{
+		outFirst = 0;
+		return true;
+	}
+
+	uint32_t runStart = 0;
+	uint32_t runLength = 0;
+
+	const uint32_t arraySize = static_cast<uint32_t>( bits.size() );
+	for ( uint32_t arrayElementIx = 0; arrayElementIx < arraySize; ++arrayElementIx )
+	{
+		const ElementType word = bits[ arrayElementIx ];
+		const uint32_t wordBase = arrayElementIx * BitsPerElement;
+
+		if ( word == 0 )
+		{
+			if ( runLength == 0 ) {
+				runStart = wordBase;
+			}
+			runLength += BitsPerElement;
+		}
+		else if ( word == ~ElementType( 0 ) )
+		{
+			runLength = 0;
+			continue;
+		}
+		else
+		{
+			// Alternate between skipping set bits and consuming clear bits
+			uint32_t bitNumber = 0;
+			while ( bitNumber < BitsPerElement )
+			{
+				const ElementType clearBits = ~word >> bitNumber;
+				if ( clearBits == 0 )
+				{
+					runLength = 0;
+					break;
+				}
+
+				const uint32_t setLength = SysCore::CountTrailingZeros( clearBits );
+				if ( setLength > 0 )
+				{
+					runLength = 0;
+					bitNumber += setLength;
+				}
+
+				const uint32_t clearLength = std::min( SysCore::CountTrailingZeros( word >> bitNumber ), BitsPerElement - bitNumber );
+				if ( runLength == 0 ) {
+					runStart = wordBase + bitNumber;
+				}
+				runLength += clearLength;
+				bitNumber += clearLength;
+
+				if ( runLength >= count ) {
+					break;
+				}
+			}
+		}
+
+		if ( runLength >= count )
+		{
+			outFirst = runStart;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// WORD_RLE markers pack a fill run and the literal words that follow it:
+// bit 63 = fill value, bits 32-62 = fill word count, bits 0-31 = literal word count
+static const uint64_t FillValueBit = 1ull << 63;
+static const uint32_t MaxFillWords = 0x7FFFFFFF;
+
+static inline uint64_t MakeRunMarker( const bool fillValue, const uint32_t fillCount, const uint32_t literalCount )
+{
+	return ( fillValue ? FillValueBit : 0 ) | ( static_cast<uint64_t>( fillCount ) << 32 ) | literalCount;
+}
+
+
+// Splits words into ( fill run, literal run ) segments, one per marker
+template<typename Func>
+static inline void ForEachWordRun( const uint64_t* words, const uint32_t wordCount, Func&& func )
+{
+	uint32_t wordIx = 0;
+	while ( wordIx < wordCount )
+	{
+		const uint64_t fillWord = words[ wordIx ];
+		const bool isFill = ( fillWord == 0 ) || ( fillWord == ~uint64_t( 0 ) );
+
+		uint32_t fillCount = 0;
+		if ( isFill )
+		{
+			while ( ( wordIx < wordCount ) && ( words[ wordIx ] == fillWord ) && ( fillCount < MaxFillWords ) )
+			{
+				++fillCount;
+				++wordIx;
+			}
+		}
+
+		const uint32_t literalStart = wordIx;
+		while ( wordIx < wordCount )
+		{
+			const uint64_t word = words[ wordIx ];
+			if ( ( word == 0 ) || ( word == ~uint64_t( 0 ) ) ) {
+				break;
+			}
+			++wordIx;
+		}
+
+		func( ( fillWord != 0 ) && isFill, fillCount, literalStart, wordIx - literalStart );
+	}
+}
+
+
+uint32_t BitArray::EncodedWordCount() const
+{
+	uint32_t encodedCount = 0;
+	ForEachWordRun( bits.data(), static_cast<uint32_t>( bits.size() ), [&]( bool, uint32_t, uint32_t, const uint32_t literalCount ) {
+		encodedCount += 1 + literalCount;
+	} );
+	return encodedCount;
+}
+
+
+bool BitArray::Serialize( Serializer* s )
+{
+	if ( s->GetMode() == serializeMode_t::STORE )
+	{
+		uint32_t wordCount = static_cast<uint32_t>( bits.size() );
+		uint8_t encoding = static_cast<uint8_t>( ( EncodedWordCount() < wordCount ) ? encoding_t::WORD_RLE : encoding_t::RAW );
+
+		s->Next( encoding );
+		s->Next( wordCount );
+
+		if ( encoding == static_cast<uint8_t>( encoding_t::RAW ) )
+		{
+			SerializeArray( s, bits.data(), wordCount );
+		}
+		else
+		{
+			ForEachWordRun( bits.data(), wordCount, [&]( const bool fillValue, const uint32_t fillCount, const uint32_t literalStart, const uint32_t literalCount ) {
+				uint64_t marker = MakeRunMarker( fillValue, fillCount, literalCount );
+				s->Next( marker );
+				SerializeArray( s, bits.data() + literalStart, literalCount );
+			} );
+		}
+		return ( s->Status() == serializeStatus_t::OK );
+	}
+
+	uint8_t encoding = 0;
+	uint32_t wordCount = 0;
+	s->Next( encoding );
+	s->Next( wordCount );
+
+	// Bit indices are 32-bit, which bounds the word count
+	const uint64_t maxWordCount = ( 1ull << 32 ) / BitsPerElement;
+	const bool validHeader = ( encoding <= static_cast<uint8_t>( encoding_t::WORD_RLE ) ) && ( wordCount <= maxWordCount );
+	if ( ( s->Status() != serializeStatus_t::OK ) || ( validHeader == false ) )
+	{
+		Reset();
+		return false;
+	}
+
+	// Decoded aside so a failed load leaves no resized array behind. RAW words and
+	// RLE literals must be backed by the remaining input, but a fill marker can still
+	// expand to the full header word count
+	decltype( bits ) loaded;
+
+	if ( encoding == static_cast<uint8_t>( encoding_t::RAW ) )
+	{
+		const uint64_t remainingWords = ( s->BufferSize() - s->CurrentSize() ) / sizeof( ElementType );
+		if ( wordCount > remainingWords )
+		{
+			Reset();
+			return false;
+		}
+		loaded.resize( wordCount );
+		SerializeArray( s, loaded.data(), wordCount );
+	}
+	else
+	{
+		uint32_t wordIx = 0;
+		while ( wordIx < wordCount )
+		{
+			uint64_t marker = 0;
+			s->Next( marker );
+
+			const ElementType fillWord = ( ( marker & FillValueBit ) != 0 ) ? ~ElementType( 0 ) : 0;
+			const uint32_t fillCount = static_cast<uint32_t>( ( marker >> 32 ) & MaxFillWords );
+			const uint32_t literalCount = static_cast<uint32_t>( marker & 0xFFFFFFFF );
+			const uint64_t literalsLeft = ( s->BufferSize() - s->CurrentSize() ) / sizeof( ElementType );
+
+			if ( ( s->Status() != serializeStatus_t::OK ) || ( static_cast<uint64_t>( fillCount ) + literalCount > ( wordCount - wordIx ) ) ||
+				( fillCount + literalCount == 0 ) || ( literalCount > literalsLeft ) )
+			{
+				Reset();
+				return false;
+			}
+
+			loaded.resize( static_cast<size_t>( wordIx ) + fillCount + literalCount, fillWord );
+			wordIx += fillCount;
+
+			SerializeArray( s, loaded.data() + wordIx, literalCount );
+			wordIx += literalCount;
+		}
+	}
+
+	if ( s->Status() != serializeStatus_t::OK )
+	{
+		Reset();
+		return false;
+	}
+	bits.swap( loaded );
+	return true;
+}
+
+
 void TestBitArray()
 {
     // --- Construction ---
@@ -251,5 +577,192 @@ void TestBitArray()
             assert( b.IsSet( i * 64 + 63 ) );
         }
     }
+
+    // --- Iteration ---
+    {
+        BitArray b;
+        const uint32_t expected[] = { 0, 5, 63, 64, 200, 1023 };
+        for ( uint32_t i = 0; i < COUNTARRAY( expected ); ++i ) {
+            b.Set( expected[ i ] );
+        }
+        uint32_t visited = 0;
+        for ( const uint32_t bit : b )
+        {
+            assert( bit == expected[ visited ] );
+            ++visited;
+        }
+        assert( visited == COUNTARRAY( expected ) );
+    }
+
+    {
+        BitArray b;
+        assert( b.begin() == b.end() );
+    }
+
+    // --- Ranges ---
+    {
+        // Range inside a single element
+        BitArray b;
+        b.SetRange( 3, 10 );
+        assert( b.Count() == 10 );
+        assert( !b.IsSet( 2 ) && b.IsSet( 3 ) && b.IsSet( 12 ) && !b.IsSet( 13 ) );
+        assert( b.CountRange( 0, 64 ) == 10 );
+        assert( b.AllSetInRange( 3, 10 ) );
+        assert( !b.AllSetInRange( 2, 10 ) );
+        assert( b.AnySetInRange( 12, 100 ) );
+        assert( !b.AnySetInRange( 13, 100 ) );
+    }
+
+    {
+        // Range spanning partial, whole and partial elements
+        BitArray b;
+        b.SetRange( 60, 200 );
+        assert( b.Count() == 200 );
+        assert( !b.IsSet( 59 ) && b.IsSet( 60 ) && b.IsSet( 259 ) && !b.IsSet( 260 ) );
+        assert( b.CountRange( 100, 100 ) == 100 );
+        assert( b.CountRange( 0, 70 ) == 10 );
+        b.ClearRange( 64, 128 );
+        assert( b.Count() == 72 );
+        assert( b.IsSet( 63 ) && !b.IsSet( 64 ) && !b.IsSet( 191 ) && b.IsSet( 192 ) );
+        assert( !b.AnySetInRange( 64, 128 ) );
+        assert( b.AllSetInRange( 192, 68 ) );
+    }
+
+    {
+        // Range auto resize and out of bounds queries
+        BitArray b( 64 );
+        b.SetRange( 100, 50 );
+        assert( b.Size() >= 150 );
+        assert( b.CountRange( 0, 0xFFFFFFFF ) == 50 );
+        assert( !b.AllSetInRange( 100, 10000 ) );
+        assert( !b.AnySetInRange( 5000, 10 ) );
+        b.ClearRange( 0, 0xFFFFFFFF );
+        assert( b.NoneSet() );
+    }
+
+    {
+        // Empty ranges
+        BitArray b;
+        b.SetRange( 10, 0 );
+        assert( b.NoneSet() );
+        assert( b.AllSetInRange( 10, 0 ) );
+        assert( !b.AnySetInRange( 10, 0 ) );
+    }
+
+    // --- First-fit search ---
+    {
+        BitArray b( 256 );
+        uint32_t first = ~0u;
+        assert( b.FindClearRun( 256, first ) && first == 0 );
+        assert( !b.FindClearRun( 257, first ) );
+
+        b.SetRange( 0, 256 );
+        assert( !b.FindClearRun( 1, first ) );
+
+        b.ClearRange( 10, 3 );
+        b.ClearRange( 60, 8 );
+        b.ClearRange( 128, 70 );
+        assert( b.FindClearRun( 1, first ) && first == 10 );
+        assert( b.FindClearRun( 3, first ) && first == 10 );
+        assert( b.FindClearRun( 4, first ) && first == 60 );
+        assert( b.FindClearRun( 8, first ) && first == 60 );
+        assert( b.FindClearRun( 9, first ) && first == 128 );
+        assert( b.FindClearRun( 70, first ) && first == 128 );
+        assert( !b.FindClearRun( 71, first ) );
+    }
+
+    // --- Serialization ---
+    {
+        // Mostly long runs, picks the run-length encoding
+        BitArray b( 64 * 1024 );
+        b.SetRange( 1000, 20000 );
+        b.Set( 40000 );
+        b.Set( 40003 );
+        b.SetRange( 50000, 64 * 1024 - 50000 );
+
+        Serializer s( KB( 64 ), serializeMode_t::STORE );
+        assert( b.Serialize( &s ) );
+        const uint32_t encodedSize = s.CurrentSize();
+        assert( encodedSize < b.Size() / 8 / 16 );
+
+        s.SetPosition( 0 );
+        s.SetMode( serializeMode_t::LOAD );
+
+        BitArray loaded( 64 );
+        assert( loaded.Serialize( &s ) );
+        assert( s.CurrentSize() == encodedSize );
+        assert( loaded.Size() == b.Size() );
+        assert( loaded.Count() == b.Count() );
+        assert( loaded.AllSetInRange( 1000, 20000 ) );
+        assert( !loaded.IsSet( 999 ) && !loaded.IsSet( 21000 ) );
+        assert( loaded.IsSet( 40000 ) && loaded.IsSet( 40003 ) && !loaded.IsSet( 40001 ) );
+        assert( loaded.AllSetInRange( 50000, 64 * 1024 - 50000 ) );
+    }
+
+    {
+        // Noisy words, falls back to the raw layout
+        BitArray b( 4096 );
+        for ( uint32_t i = 0; i < 4096; i += 3 ) {
+            b.Set( i );
+        }
+
+        Serializer s( KB( 4 ), serializeMode_t::STORE );
+        assert( b.Serialize( &s ) );
+        assert( s.CurrentSize() == sizeof( uint8_t ) + sizeof( uint32_t ) + b.Size() / 8 );
+
+        s.SetPosition( 0 );
+        s.SetMode( serializeMode_t::LOAD );
+
+        BitArray loaded;
+        assert( loaded.Serialize( &s ) );
+        assert( loaded.Count() == b.Count() );
+        for ( const uint32_t bit : loaded ) {
+            assert( ( bit % 3 ) == 0 );
+        }
+    }
+
+    {
+        // Truncated input is rejected
+        BitArray b( 1024 );
+        b.Set( 1 );
+        b.Set( 700 );
+
+        Serializer s( KB( 1 ), serializeMode_t::STORE );
+        assert( b.Serialize( &s ) );
+        const uint32_t size = s.CurrentSize();
+
+        Serializer truncated( size - 4, serializeMode_t::LOAD );
+        memcpy( truncated.GetPtr(), s.GetPtr(), size - 4 );
+
+        BitArray loaded;
+        assert( !loaded.Serialize( &truncated ) );
+        assert( loaded.NoneSet() );
+    }
+
+    {
+        // Headers claiming more words than the input holds fail without resizing
+        for ( const uint8_t encoding : { uint8_t( 0 ), uint8_t( 1 ) } )
+        {
+            Serializer s( 64, serializeMode_t::STORE );
+            uint8_t storedEncoding = encoding;
+            uint32_t wordCount = ( 1u << 26 );
+            uint64_t marker = 3;	// Three literal words, only one follows
+            uint64_t word = 0x5;
+            s.Next( storedEncoding );
+            s.Next( wordCount );
+            s.Next( marker );
+            s.Next( word );
+            const uint32_t size = s.CurrentSize();
+
+            Serializer input( size, serializeMode_t::LOAD );
+            memcpy( input.GetPtr(), s.GetPtr(), size );
+
+            BitArray loaded( 200 );
+            loaded.Set( 150 );
+            assert( !loaded.Serialize( &input ) );
+            assert( loaded.Size() == 256 );
+            assert( loaded.NoneSet() );
+        }
+    }
 }
 }
\ No newline at end of file
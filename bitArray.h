@@ -7,6 +7,10 @@
 #include <vector>
 
 #include "common.h"
+#include "bitIterator.h"
+#include "memTracker.h"
+
+class Serializer;
 
 namespace SysCore
 {
@@ -19,7 +23,15 @@ private:
 	using ElementType = uint64_t;
 	static constexpr uint32_t BitsPerElement = 8 * sizeof( ElementType );
 
-	std::vector<ElementType> bits;
+	std::vector<ElementType, TaggedAllocator<ElementType, memTag_t::BIT_ARRAY>> bits;
+
+	enum class encoding_t : uint8_t
+	{
+		RAW,
+		WORD_RLE,
+	};
+
+	uint32_t		EncodedWordCount() const;
 
 public:
 
@@ -48,5 +60,50 @@ public:
 
 	[[nodiscard]]
 	bool			IsSet( const uint32_t element ) const;
+
+	// Range operations cover the bits [first, first + count)
+	void			SetRange( const uint32_t first, const uint32_t count );
+
+	void			ClearRange( const uint32_t first, const uint32_t count );
+
+	[[nodiscard]]
+	uint32_t		CountRange( const uint32_t first, const uint32_t count ) const;
+
+	[[nodiscard]]
+	bool			AllSetInRange( const uint32_t first, const uint32_t count ) const;
+
+	[[nodiscard]]
+	bool			AnySetInRange( const uint32_t first, const uint32_t count ) const;
+
+	// First-fit search for a run of clear bits within Size()
+	[[nodiscard]]
+	bool			FindClearRun( const uint32_t count, uint32_t& outFirst ) const;
+
+	// Stores or loads depending on the serializer mode. Runs of all-clear or
+	// all-set words are run-length encoded when that is smaller than the raw words.
+	// Returns false on a malformed load
+	bool			Serialize( Serializer* s );
+
+	// Raw storage for code that walks the bits a word at a time
+	const uint64_t*	Words() const
+	{
+		return bits.data();
+	}
+
+	uint32_t		WordCount() const
+	{
+		return static_cast<uint32_t>( bits.size() );
+	}
+
+	BitIterator		begin() const
+	{
+		return BitIterator( bits.data(), static_cast<uint32_t>( bits.size() ), 0 );
+	}
+
+	BitIterator		end() const
+	{
+		const uint32_t arraySize = static_cast<uint32_t>( bits.size() );
+		return BitIterator( bits.data(), arraySize, arraySize );
+	}
 };
 }
\ No newline at end of file
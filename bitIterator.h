@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.h"
+
+namespace SysCore
+{
+// Walks the set bits of a word array, yielding bit indices in ascending order
+class BitIterator
+{
+private:
+	const uint64_t*	words;
+	uint32_t		wordCount;
+	uint32_t		wordIx;
+	uint64_t		current;
+
+	constexpr void SkipEmpty()
+	{
+		while ( ( current == 0 ) && ( ++wordIx < wordCount ) ) {
+			current = words[ wordIx ];
+		}
+	}
+
+public:
+	constexpr BitIterator( const uint64_t* _words, const uint32_t _wordCount, const uint32_t _wordIx )
+		: words( _words ), wordCount( _wordCount ), wordIx( _wordIx ), current( 0 )
+	{
+		if ( wordIx < wordCount )
+		{
+			current = words[ wordIx ];
+			SkipEmpty();
+		}
+	}
+
+	constexpr uint32_t operator*() const
+	{
+		return ( wordIx * 64 ) + SysCore::CountTrailingZeros( current );
+	}
+
+	constexpr BitIterator& operator++()
+	{
+		current &= ( current - 1 );
+		SkipEmpty();
+		return *this;
+	}
+
+	constexpr bool operator==( const BitIterator& rhs ) const {
+		return ( wordIx == rhs.wordIx ) && ( current == rhs.current );
+	}
+
+	constexpr bool operator!=( const BitIterator& rhs ) const {
+		return !( *this == rhs );
+	}
+};
+}
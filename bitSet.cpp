@@ -0,0 +1,84 @@
+#include "bitSet.h"
+
+#include <type_traits>
+
+namespace SysCore
+{
+void TestBitSet()
+{
+    static_assert( std::is_trivially_copyable_v<BitSet<32>>, "BitSet must stay trivially copyable" );
+    static_assert( sizeof( BitSet<32> ) == sizeof( uint64_t ), "BitSet<32> should fit in one word" );
+    static_assert( sizeof( BitSet<65> ) == 2 * sizeof( uint64_t ), "BitSet<65> should use two words" );
+
+    // --- Compile-time use ---
+    {
+        constexpr BitSet<32> mask = []() {
+            BitSet<32> b;
+            b.Set( 1 );
+            b.Set( 31 );
+            return b;
+        }();
+        static_assert( mask.IsSet( 1 ) && mask.IsSet( 31 ) && !mask.IsSet( 2 ), "constexpr Set failed" );
+        static_assert( mask.Count() == 2, "constexpr Count failed" );
+    }
+
+    // --- Construction ---
+    {
+        BitSet<128> b;
+        assert( b.NoneSet() );
+        assert( !b.AnySet() );
+        assert( b.Count() == 0 );
+        assert( b.Size() == 128 );
+    }
+
+    // --- Set, Clear, IsSet ---
+    {
+        BitSet<100> b;
+        b.Set( 0 );
+        b.Set( 63 );
+        b.Set( 64 );
+        b.Set( 99 );
+        assert( b.Count() == 4 );
+        assert( b.IsSet( 63 ) && b.IsSet( 64 ) && b.IsSet( 99 ) );
+        assert( !b.IsSet( 100 ) );
+        b.Clear( 63 );
+        assert( !b.IsSet( 63 ) );
+        assert( b.Count() == 3 );
+        b.Clear( 500 );
+        b.Reset();
+        assert( b.NoneSet() );
+    }
+
+    // --- Iteration ---
+    {
+        BitSet<200> b;
+        const uint32_t expected[] = { 3, 64, 127, 128, 199 };
+        for ( uint32_t i = 0; i < COUNTARRAY( expected ); ++i ) {
+            b.Set( expected[ i ] );
+        }
+        uint32_t visited = 0;
+        for ( const uint32_t bit : b )
+        {
+            assert( bit == expected[ visited ] );
+            ++visited;
+        }
+        assert( visited == COUNTARRAY( expected ) );
+    }
+
+    // --- Bitwise ops ---
+    {
+        BitSet<64> a;
+        BitSet<64> b;
+        a.Set( 1 );
+        a.Set( 2 );
+        b.Set( 2 );
+        b.Set( 3 );
+        assert( ( a | b ).Count() == 3 );
+        assert( ( a & b ).Count() == 1 );
+        assert( ( a & b ).IsSet( 2 ) );
+        assert( a != b );
+        BitSet<64> c = a;
+        assert( a == c );
+    }
+}
+}
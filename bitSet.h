@@ -0,0 +1,155 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+
+#include "common.h"
+#include "bitIterator.h"
+
+namespace SysCore
+{
+void TestBitSet();
+
+// Fixed-capacity bit array with inline storage. Mirrors the BitArray query API
+// but never allocates and stays trivially copyable for SerializeStruct()
+template<uint32_t N>
+class BitSet
+{
+private:
+
+	using ElementType = uint64_t;
+	static constexpr uint32_t BitsPerElement = 8 * sizeof( ElementType );
+	static constexpr uint32_t ElementCount = ( N + BitsPerElement - 1 ) / BitsPerElement;
+
+	static_assert( N > 0, "BitSet requires at least one bit" );
+
+	ElementType bits[ ElementCount ] = {};
+
+public:
+
+	constexpr BitSet() = default;
+
+	constexpr void Reset()
+	{
+		for ( uint32_t i = 0; i < ElementCount; ++i ) {
+			bits[ i ] = 0;
+		}
+	}
+
+	constexpr void Set( const uint32_t element )
+	{
+		if ( element >= N )
+		{
+			assert( 0 );
+			return;
+		}
+		bits[ element / BitsPerElement ] |= ( ElementType( 1 ) << ( element % BitsPerElement ) );
+	}
+
+	constexpr void Clear( const uint32_t element )
+	{
+		if ( element < N ) {
+			bits[ element / BitsPerElement ] &= ~( ElementType( 1 ) << ( element % BitsPerElement ) );
+		}
+	}
+
+	[[nodiscard]]
+	constexpr uint32_t Count() const
+	{
+		uint32_t count = 0;
+		for ( uint32_t i = 0; i < ElementCount; ++i ) {
+			count += SysCore::Popcount( bits[ i ] );
+		}
+		return count;
+	}
+
+	[[nodiscard]]
+	constexpr bool AnySet() const
+	{
+		return ( NoneSet() == false );
+	}
+
+	[[nodiscard]]
+	constexpr bool NoneSet() const
+	{
+		for ( uint32_t i = 0; i < ElementCount; ++i )
+		{
+			if ( bits[ i ] != 0 ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	[[nodiscard]]
+	constexpr uint32_t Size() const
+	{
+		return N;
+	}
+
+	[[nodiscard]]
+	constexpr bool IsSet( const uint32_t element ) const
+	{
+		if ( element >= N ) {
+			return false;
+		}
+		return ( bits[ element / BitsPerElement ] & ( ElementType( 1 ) << ( element % BitsPerElement ) ) ) != 0;
+	}
+
+	constexpr BitIterator begin() const
+	{
+		return BitIterator( bits, ElementCount, 0 );
+	}
+
+	constexpr BitIterator end() const
+	{
+		return BitIterator( bits, ElementCount, ElementCount );
+	}
+
+	constexpr BitSet& operator|=( const BitSet& rhs )
+	{
+		for ( uint32_t i = 0; i < ElementCount; ++i ) {
+			bits[ i ] |= rhs.bits[ i ];
+		}
+		return *this;
+	}
+
+	constexpr BitSet& operator&=( const BitSet& rhs )
+	{
+		for ( uint32_t i = 0; i < ElementCount; ++i ) {
+			bits[ i ] &= rhs.bits[ i ];
+		}
+		return *this;
+	}
+
+	constexpr BitSet operator|( const BitSet& rhs ) const
+	{
+		BitSet result = *this;
+		result |= rhs;
+		return result;
+	}
+
+	constexpr BitSet operator&( const BitSet& rhs ) const
+	{
+		BitSet result = *this;
+		result &= rhs;
+		return result;
+	}
+
+	constexpr bool operator==( const BitSet& rhs ) const
+	{
+		for ( uint32_t i = 0; i < ElementCount; ++i )
+		{
+			if ( bits[ i ] != rhs.bits[ i ] ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	constexpr bool operator!=( const BitSet& rhs ) const
+	{
+		return !( *this == rhs );
+	}
+};
+}
@@ -8,6 +8,9 @@ const uint32_t KB_1 = 1024;
 const uint32_t MB_1 = 1024 * KB_1;
 const uint32_t GB_1 = 1024 * MB_1;
 
+// Separation used to keep independently written atomics off the same line
+const uint32_t CACHE_LINE_SIZE = 64;
+
 #define KB( N ) ( N * KB_1 )
 #define MB( N ) ( N * MB_1 )
 #define GB( N ) ( N * GB_1 )
@@ -144,13 +147,21 @@ static inline uint32_t RoundUpToPowerOfTwo( uint32_t value )
 }
 
 
-static inline uint32_t Popcount( const uint64_t value )
+static constexpr inline uint32_t Popcount( const uint64_t value )
 {
 	uint64_t x = value;
 
 	x = x - ( ( x >> 1 ) & 0x5555555555555555ull );
 	x = ( x & 0x3333333333333333ull ) + ( ( x >> 2 ) & 0x3333333333333333ull );
 	x = ( x + ( x >> 4 ) ) & 0x0F0F0F0F0F0F0F0Full;
-	return ( x * 0x0101010101010101ull ) >> 56;
+	return static_cast<uint32_t>( ( x * 0x0101010101010101ull ) >> 56 );
+}
+
+
+// Index of the lowest set bit, 64 when value is 0
+static constexpr inline uint32_t CountTrailingZeros( const uint64_t value )
+{
+	if ( value == 0 ) return 64;
+	return Popcount( ( value & ( ~value + 1 ) ) - 1 );
 }
 };
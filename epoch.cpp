@@ -0,0 +1,346 @@
+#include "epoch.h"
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+#include "threadRegistry.h"
+#include "timer.h"
+
+namespace SysCore
+{
+static const uint64_t InactiveEpoch = ~0ull;
+
+// Retire lists are scanned once they reach this size
+static const uint32_t ReclaimThreshold = 64;
+
+struct retired_t
+{
+	void*		object;
+	void		( *deleter )( void* );
+	uint64_t	epoch;
+};
+
+// One per thread that has used the epoch system, the reclaimer walks them all
+struct epochRecord_t
+{
+	std::atomic<uint64_t>	epoch{ InactiveEpoch };	// Epoch seen on entry, InactiveEpoch outside a guard
+	uint32_t				nesting = 0;
+	std::vector<retired_t>	retired;				// Owner thread only
+};
+
+struct epochState_t
+{
+	std::atomic<uint64_t>		globalEpoch{ 0 };
+
+	std::mutex					orphanLock;
+	std::vector<retired_t>		orphans;	// Left behind by exited threads
+};
+
+
+static epochState_t& EpochState()
+{
+	static epochState_t state;
+	return state;
+}
+
+
+// Hands an exiting thread's retire list to the others
+static void RetireRecord( epochRecord_t& record )
+{
+	assert( record.nesting == 0 );
+
+	if ( record.retired.empty() == false )
+	{
+		epochState_t& state = EpochState();
+		std::lock_guard<std::mutex> guard( state.orphanLock );
+		state.orphans.insert( state.orphans.end(), record.retired.begin(), record.retired.end() );
+		record.retired.clear();
+	}
+	record.epoch.store( InactiveEpoch, std::memory_order_release );
+}
+
+
+using epochRegistry_t = ThreadRegistry<epochRecord_t, RetireRecord>;
+
+
+static inline epochRecord_t& ThreadRecord()
+{
+	return epochRegistry_t::Local();
+}
+
+
+// The epoch can move on once every thread inside a guard has seen the current one
+static uint64_t TryAdvance()
+{
+	epochState_t& state = EpochState();
+
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	uint64_t current = state.globalEpoch.load( std::memory_order_acquire );
+
+	bool behind = false;
+	epochRegistry_t::ForEach( [&behind, current]( const epochRecord_t& record ) {
+		const uint64_t epoch = record.epoch.load( std::memory_order_acquire );
+		behind = behind || ( ( epoch != InactiveEpoch ) && ( epoch != current ) );
+	} );
+	if ( behind ) {
+		return current;
+	}
+
+	if ( state.globalEpoch.compare_exchange_strong( current, current + 1, std::memory_order_acq_rel ) ) {
+		return current + 1;
+	}
+	return current; // Someone else advanced it
+}
+
+
+// Frees entries retired at least two epochs ago, keeps the rest in order
+static uint32_t FreeExpired( std::vector<retired_t>& retired, const uint64_t epoch )
+{
+	uint32_t freedCount = 0;
+	uint32_t keepCount = 0;
+	for ( uint32_t i = 0; i < static_cast<uint32_t>( retired.size() ); ++i )
+	{
+		const retired_t& entry = retired[ i ];
+		if ( ( entry.epoch + 2 ) <= epoch )
+		{
+			entry.deleter( entry.object );
+			++freedCount;
+		}
+		else
+		{
+			retired[ keepCount++ ] = entry;
+		}
+	}
+	retired.resize( keepCount );
+	return freedCount;
+}
+
+
+void EpochEnter()
+{
+	epochRecord_t& record = ThreadRecord();
+	if ( record.nesting++ == 0 )
+	{
+		const uint64_t epoch = EpochState().globalEpoch.load( std::memory_order_relaxed );
+		record.epoch.store( epoch, std::memory_order_relaxed );
+		// Our epoch must be visible before any shared pointer is read
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+	}
+}
+
+
+void EpochExit()
+{
+	epochRecord_t& record = ThreadRecord();
+	assert( record.nesting > 0 );
+	if ( --record.nesting == 0 ) {
+		record.epoch.store( InactiveEpoch, std::memory_order_release );
+	}
+}
+
+
+void EpochRetire( void* object, void ( *deleter )( void* ) )
+{
+	if ( object == nullptr ) {
+		return;
+	}
+
+	epochRecord_t& record = ThreadRecord();
+	record.retired.push_back( { object, deleter, EpochState().globalEpoch.load( std::memory_order_acquire ) } );
+
+	if ( record.retired.size() >= ReclaimThreshold ) {
+		EpochReclaim();
+	}
+}
+
+
+uint32_t EpochReclaim()
+{
+	epochState_t& state = EpochState();
+	epochRecord_t& record = ThreadRecord();
+
+	const uint64_t epoch = TryAdvance();
+	uint32_t freedCount = FreeExpired( record.retired, epoch );
+
+	if ( state.orphanLock.try_lock() )
+	{
+		freedCount += FreeExpired( state.orphans, epoch );
+		state.orphanLock.unlock();
+	}
+	return freedCount;
+}
+
+
+void EpochDrain()
+{
+	epochState_t& state = EpochState();
+	assert( ThreadRecord().nesting == 0 );
+
+	for ( ;; )
+	{
+		EpochReclaim();
+
+		bool orphansLeft;
+		{
+			std::lock_guard<std::mutex> guard( state.orphanLock );
+			orphansLeft = ( state.orphans.empty() == false );
+		}
+		if ( ( EpochPendingCount() == 0 ) && ( orphansLeft == false ) ) {
+			return;
+		}
+		std::this_thread::yield();
+	}
+}
+
+
+uint32_t EpochPendingCount()
+{
+	return static_cast<uint32_t>( ThreadRecord().retired.size() );
+}
+
+
+uint64_t EpochCurrent()
+{
+	return EpochState().globalEpoch.load( std::memory_order_acquire );
+}
+
+
+struct epochTestObject_t
+{
+	static const uint64_t LiveMagic = 0x1234567812345678ull;
+
+	uint64_t	magic;
+	uint64_t	version;
+
+	static inline std::atomic<int> liveCount{ 0 };
+
+	epochTestObject_t( const uint64_t _version ) : magic( LiveMagic ), version( _version ) { liveCount.fetch_add( 1 ); }
+	~epochTestObject_t() { magic = 0; liveCount.fetch_sub( 1 ); }
+};
+
+
+void TestEpoch()
+{
+    // --- Nested guards and deferred frees ---
+    {
+        const uint64_t startEpoch = EpochCurrent();
+        epochTestObject_t* object = new epochTestObject_t( 0 );
+        {
+            EpochGuard outer;
+            {
+                EpochGuard inner;
+            }
+            EpochRetire( object );
+            EpochReclaim();
+            EpochReclaim();
+
+            // Still inside a guard from the retire epoch, so nothing can be freed
+            assert( epochTestObject_t::liveCount == 1 );
+            assert( object->magic == epochTestObject_t::LiveMagic );
+        }
+        EpochDrain();
+        assert( epochTestObject_t::liveCount == 0 );
+        assert( EpochPendingCount() == 0 );
+        assert( EpochCurrent() >= startEpoch + 2 );
+    }
+
+    // --- Readers never see freed versions while a writer swaps ---
+    {
+        EpochPtr<epochTestObject_t> shared( new epochTestObject_t( 0 ) );
+        std::atomic<bool> done( false );
+        const uint32_t versionCount = 20000;
+
+        std::vector<std::thread> readers;
+        for ( uint32_t t = 0; t < 3; ++t )
+        {
+            readers.emplace_back( [&]() {
+                uint64_t lastVersion = 0;
+                while ( done.load( std::memory_order_acquire ) == false )
+                {
+                    EpochGuard guard;
+                    const epochTestObject_t* object = shared.Load();
+                    assert( object->magic == epochTestObject_t::LiveMagic );
+                    assert( object->version >= lastVersion );
+                    lastVersion = object->version;
+                }
+            } );
+        }
+
+        std::thread writer( [&]() {
+            for ( uint64_t version = 1; version <= versionCount; ++version ) {
+                shared.Publish( new epochTestObject_t( version ) );
+            }
+            // Leaves its pending objects to the other threads
+        } );
+        writer.join();
+
+        done.store( true, std::memory_order_release );
+        for ( std::thread& reader : readers ) {
+            reader.join();
+        }
+
+        EpochDrain();
+        assert( epochTestObject_t::liveCount == 1 );
+        assert( shared.Load()->version == versionCount );
+    }
+    assert( epochTestObject_t::liveCount == 0 );
+}
+
+
+void BenchmarkEpoch()
+{
+    struct payload_t { uint64_t values[ 8 ]; };
+
+    const uint32_t maxThreads = std::max( 2u, std::thread::hardware_concurrency() );
+    const uint32_t readsPerThread = 1 << 22;
+
+    for ( uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2 )
+    {
+        EpochPtr<payload_t> epochShared( new payload_t{} );
+        payload_t* lockedShared = new payload_t{};
+        std::mutex lock;
+        uint64_t elapsed[ 2 ] = {};
+
+        // Readers only, the cost of the read side is what matters here
+        for ( uint32_t mode = 0; mode < 2; ++mode )
+        {
+            Timer timer( "Epoch", timerPrecision_t::MICROSECOND );
+            std::vector<std::thread> threads;
+            for ( uint32_t t = 0; t < threadCount; ++t )
+            {
+                threads.emplace_back( [&]() {
+                    uint64_t sum = 0;
+                    for ( uint32_t i = 0; i < readsPerThread; ++i )
+                    {
+                        if ( mode == 0 )
+                        {
+                            std::lock_guard<std::mutex> guard( lock );
+                            sum += lockedShared->values[ i & 7 ];
+                        }
+                        else
+                        {
+                            EpochGuard guard;
+                            sum += epochShared.Load()->values[ i & 7 ];
+                        }
+                    }
+                    assert( sum == 0 );
+                } );
+            }
+            for ( std::thread& thread : threads ) {
+                thread.join();
+            }
+            timer.Stop();
+            elapsed[ mode ] = std::max<uint64_t>( 1, timer.GetElapsed() );
+        }
+        delete lockedShared;
+
+        const uint64_t totalReads = static_cast<uint64_t>( readsPerThread ) * threadCount;
+        std::cout << "Epoch " << threadCount << " readers: mutex " << ( totalReads / elapsed[ 0 ] ) << "M reads/s, epoch guard "
+            << ( totalReads / elapsed[ 1 ] ) << "M reads/s" << std::endl;
+    }
+}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <assert.h>
+#include <atomic>
+#include <cstdint>
+
+namespace SysCore
+{
+void TestEpoch();
+void BenchmarkEpoch();
+
+// Epoch-based reclamation. Readers wrap accesses to shared objects in an
+// EpochGuard, which only publishes the current epoch in a per-thread slot, so
+// reads never wait. Writers unlink an object and hand it to EpochRetire(); it
+// is freed once the global epoch has advanced twice past its retirement, at
+// which point every reader that could have seen it has left its guard.
+// Guards nest. Objects retired by exiting threads are adopted by the others.
+
+void		EpochEnter();
+void		EpochExit();
+
+void		EpochRetire( void* object, void ( *deleter )( void* ) );
+
+template<class T>
+inline void EpochRetire( T* object )
+{
+	EpochRetire( object, []( void* ptr ) { delete static_cast<T*>( ptr ); } );
+}
+
+// Tries to advance the epoch and frees whatever is now unreachable, returns
+// the number of objects freed. Called automatically as retire lists grow
+uint32_t	EpochReclaim();
+
+// Waits until everything retired so far has been freed. Must not be called
+// from inside a guard
+void		EpochDrain();
+
+// Objects retired by this thread and not yet freed
+uint32_t	EpochPendingCount();
+
+uint64_t	EpochCurrent();
+
+
+class EpochGuard
+{
+public:
+	EpochGuard()
+	{
+		EpochEnter();
+	}
+
+	~EpochGuard()
+	{
+		EpochExit();
+	}
+
+	EpochGuard( const EpochGuard& ) = delete;
+	EpochGuard& operator=( const EpochGuard& ) = delete;
+};
+
+
+// Pointer to a shared object that readers load under an EpochGuard and writers
+// replace wholesale. Replaced versions are retired, not deleted
+template<class T>
+class EpochPtr
+{
+private:
+	std::atomic<T*>	object;
+
+public:
+	EpochPtr() : object( nullptr )
+	{}
+
+	explicit EpochPtr( T* initial ) : object( initial )
+	{}
+
+	// No readers may be left when this runs
+	~EpochPtr()
+	{
+		delete object.load( std::memory_order_acquire );
+	}
+
+	EpochPtr( const EpochPtr& ) = delete;
+	EpochPtr& operator=( const EpochPtr& ) = delete;
+
+	// Only valid until the caller's guard ends
+	inline T* Load() const
+	{
+		return object.load( std::memory_order_acquire );
+	}
+
+	inline void Publish( T* newObject )
+	{
+		T* previous = object.exchange( newObject, std::memory_order_acq_rel );
+		if ( previous != nullptr ) {
+			EpochRetire( previous );
+		}
+	}
+};
+}
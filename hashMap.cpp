@@ -0,0 +1,165 @@
+#include "hashMap.h"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SysCore
+{
+template<typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    uint32_t* liveBlocks;
+
+    CountingAllocator( uint32_t* _liveBlocks ) : liveBlocks( _liveBlocks ) {}
+
+    template<typename U>
+    CountingAllocator( const CountingAllocator<U>& rhs ) : liveBlocks( rhs.liveBlocks ) {}
+
+    T* allocate( const size_t n )
+    {
+        ++( *liveBlocks );
+        return std::allocator<T>().allocate( n );
+    }
+
+    void deallocate( T* p, const size_t n )
+    {
+        --( *liveBlocks );
+        std::allocator<T>().deallocate( p, n );
+    }
+
+    template<typename U>
+    bool operator==( const CountingAllocator<U>& rhs ) const { return liveBlocks == rhs.liveBlocks; }
+
+    template<typename U>
+    bool operator!=( const CountingAllocator<U>& rhs ) const { return liveBlocks != rhs.liveBlocks; }
+};
+
+
+void TestHashMap()
+{
+    // --- Basic insert, find, erase ---
+    {
+        HashMap<uint32_t, uint32_t> map;
+        assert( map.Count() == 0 );
+        assert( map.Find( 1 ) == nullptr );
+        assert( !map.Erase( 1 ) );
+
+        assert( map.Insert( 1, 10 ) );
+        assert( !map.Insert( 1, 20 ) );
+        assert( *map.Find( 1 ) == 10 );
+        map[ 2 ] = 20;
+        assert( map[ 2 ] == 20 );
+        assert( map.Count() == 2 );
+        assert( map.Erase( 1 ) );
+        assert( !map.Contains( 1 ) );
+        assert( map.Contains( 2 ) );
+        assert( map.Count() == 1 );
+    }
+
+    // --- Inserting from an element of the map while it grows ---
+    {
+        using value_t = std::vector<uint32_t>;
+        HashMap<uint32_t, value_t> map;
+        const value_t value( 16, 7 );
+        map.Insert( 0, value );
+        uint32_t growths = 0;
+        for ( uint32_t i = 1; i < 1000; ++i )
+        {
+            const uint32_t capacity = map.Capacity();
+            assert( map.Insert( i, *map.Find( i - 1 ) ) );
+            map.Emplace( i + 5000, *map.Find( i / 2 ) );
+            growths += ( map.Capacity() != capacity ) ? 1 : 0;
+            assert( *map.Find( i ) == value );
+        }
+        assert( growths >= 4 );
+        assert( *map.Find( 5999 ) == value );
+    }
+
+    // --- Randomized against std::unordered_map, with growth and tombstones ---
+    {
+        HashMap<uint64_t, std::string> map;
+        std::unordered_map<uint64_t, std::string> reference;
+        std::mt19937_64 rng( 1234 );
+
+        for ( uint32_t i = 0; i < 200000; ++i )
+        {
+            const uint64_t key = rng() % 5000;
+            const uint32_t op = static_cast<uint32_t>( rng() % 3 );
+            if ( op == 0 )
+            {
+                const std::string value = std::to_string( key * 7 );
+                assert( map.Insert( key, value ) == reference.emplace( key, value ).second );
+            }
+            else if ( op == 1 )
+            {
+                assert( map.Erase( key ) == ( reference.erase( key ) == 1 ) );
+            }
+            else
+            {
+                const std::string* value = map.Find( key );
+                auto it = reference.find( key );
+                assert( ( value != nullptr ) == ( it != reference.end() ) );
+                assert( ( value == nullptr ) || ( *value == it->second ) );
+            }
+        }
+        assert( map.Count() == reference.size() );
+
+        uint32_t visited = 0;
+        map.ForEach( [&]( const uint64_t key, const std::string& value ) {
+            assert( reference.at( key ) == value );
+            ++visited;
+        } );
+        assert( visited == reference.size() );
+
+        HashMap<uint64_t, std::string> copy = map;
+        assert( copy.Count() == map.Count() );
+        HashMap<uint64_t, std::string> moved = std::move( copy );
+        assert( moved.Count() == map.Count() && copy.Count() == 0 );
+    }
+
+    // --- Handle and precomputed hash keys ---
+    {
+        HashMap<hdl_t, uint32_t> handles;
+        for ( uint64_t i = 0; i < 1000; ++i ) {
+            handles.Insert( hdl_t( i << 32 ), static_cast<uint32_t>( i ) );
+        }
+        assert( *handles.Find( hdl_t( 500ull << 32 ) ) == 500 );
+        assert( handles.Find( INVALID_HDL ) == nullptr );
+
+        HashMap<uint64_t, uint32_t, HashMapIdentityHasher> hashed;
+        const std::string name = "diffuse";
+        const uint64_t key = SysCore::Hash( reinterpret_cast<const uint8_t*>( name.data() ), name.size() );
+        hashed.Insert( key, 3 );
+        assert( *hashed.Find( key ) == 3 );
+    }
+
+    // --- Reserve, fast clear and custom allocator ---
+    {
+        uint32_t liveBlocks = 0;
+        {
+            using Allocator = CountingAllocator<std::pair<uint32_t, uint32_t>>;
+            HashMap<uint32_t, uint32_t, HashMapHasher<uint32_t>, Allocator> map{ Allocator( &liveBlocks ) };
+            map.Reserve( 1000 );
+            const uint32_t reserved = map.Capacity();
+            assert( reserved >= 1000 );
+            assert( liveBlocks == 2 );
+
+            for ( uint32_t i = 0; i < 1000; ++i ) {
+                map.Insert( i, i );
+            }
+            assert( map.Capacity() == reserved );
+
+            map.Clear();
+            assert( map.Count() == 0 );
+            assert( map.Capacity() == reserved );
+            assert( !map.Contains( 10 ) );
+            assert( liveBlocks == 2 );
+        }
+        assert( liveBlocks == 0 );
+    }
+}
+}
@@ -0,0 +1,482 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#define HASHMAP_SSE2 1
+#include <emmintrin.h>
+#else
+#define HASHMAP_SSE2 0
+#endif
+
+#include "common.h"
+#include "handle.h"
+#include "memTracker.h"
+
+namespace SysCore
+{
+void TestHashMap();
+
+// Default hasher, mixes integer keys so sequential values spread across groups
+template<typename K>
+struct HashMapHasher
+{
+	static_assert( std::is_integral_v<K> || std::is_enum_v<K>, "HashMapHasher needs an integer key, provide a hasher for other types" );
+
+	inline uint64_t operator()( const K key ) const
+	{
+		uint64_t x = static_cast<uint64_t>( key );
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdull;
+		x ^= x >> 33;
+		return x;
+	}
+};
+
+template<typename T>
+struct HashMapHasher<Handle<T>>
+{
+	inline uint64_t operator()( const Handle<T>& key ) const
+	{
+		return HashMapHasher<uint64_t>()( static_cast<uint64_t>( key.Get() ) );
+	}
+};
+
+// For keys that already are well-mixed hashes, such as SysCore::Hash() results
+struct HashMapIdentityHasher
+{
+	inline uint64_t operator()( const uint64_t key ) const
+	{
+		return key;
+	}
+};
+
+// Open-addressing hash map with Swiss-table control bytes. Each slot has one
+// control byte: empty, deleted, or the low 7 bits of the key's hash. Lookups
+// compare a whole group of 16 control bytes at once (SSE2 when available) and
+// only touch slots whose 7-bit tag matches. Groups are aligned, so probing walks
+// groups quadratically and stops at the first group holding an empty slot
+template<class K, class V, class Hasher = HashMapHasher<K>, class Allocator = TaggedAllocator<std::pair<K, V>, memTag_t::CONTAINER>>
+class HashMap
+{
+private:
+	static constexpr uint32_t	GroupWidth = 16;
+	static constexpr uint32_t	MinCapacity = GroupWidth;
+	static constexpr uint8_t	CtrlEmpty = 0x80;
+	static constexpr uint8_t	CtrlDeleted = 0xFE;
+
+	struct slot_t
+	{
+		K	key;
+		V	value;
+	};
+
+	using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<slot_t>;
+	using CtrlAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>;
+	using SlotTraits = std::allocator_traits<SlotAllocator>;
+	using CtrlTraits = std::allocator_traits<CtrlAllocator>;
+
+	static constexpr bool IsTrivial = std::is_trivially_destructible_v<K> && std::is_trivially_destructible_v<V>;
+
+	uint8_t*		ctrl;
+	slot_t*			slots;
+	uint32_t		capacity;
+	uint32_t		count;
+	uint32_t		growthLeft;
+	Hasher			hasher;
+	SlotAllocator	slotAllocator;
+	CtrlAllocator	ctrlAllocator;
+
+	// Bit i set when control byte i of the group matches
+	static inline uint32_t MatchByte( const uint8_t* group, const uint8_t value )
+	{
+#if HASHMAP_SSE2
+		const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i*>( group ) );
+		return static_cast<uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( bytes, _mm_set1_epi8( static_cast<char>( value ) ) ) ) );
+#else
+		uint32_t mask = 0;
+		for ( uint32_t i = 0; i < GroupWidth; ++i ) {
+			mask |= ( group[ i ] == value ) ? ( 1u << i ) : 0;
+		}
+		return mask;
+#endif
+	}
+
+	// Empty and deleted both have the high bit set, full slots never do
+	static inline uint32_t MatchFree( const uint8_t* group )
+	{
+#if HASHMAP_SSE2
+		const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i*>( group ) );
+		return static_cast<uint32_t>( _mm_movemask_epi8( bytes ) );
+#else
+		uint32_t mask = 0;
+		for ( uint32_t i = 0; i < GroupWidth; ++i ) {
+			mask |= ( ( group[ i ] & 0x80 ) != 0 ) ? ( 1u << i ) : 0;
+		}
+		return mask;
+#endif
+	}
+
+	static inline uint8_t Tag( const uint64_t hash )
+	{
+		return static_cast<uint8_t>( hash & 0x7F );
+	}
+
+	static inline uint32_t MaxLoad( const uint32_t slotCount )
+	{
+		return slotCount - ( slotCount / 8 );
+	}
+
+	inline uint32_t GroupMask() const
+	{
+		return ( capacity / GroupWidth ) - 1;
+	}
+
+	inline uint32_t FirstGroup( const uint64_t hash ) const
+	{
+		return static_cast<uint32_t>( hash >> 7 ) & GroupMask();
+	}
+
+	// Returns the slot index holding key, or capacity when absent
+	inline uint32_t FindIndex( const K& key, const uint64_t hash ) const
+	{
+		if ( capacity == 0 ) {
+			return capacity;
+		}
+
+		const uint8_t tag = Tag( hash );
+		uint32_t groupIx = FirstGroup( hash );
+		for ( uint32_t step = 1; step <= ( capacity / GroupWidth ); ++step )
+		{
+			const uint8_t* group = ctrl + groupIx * GroupWidth;
+
+			uint32_t match = MatchByte( group, tag );
+			while ( match != 0 )
+			{
+				const uint32_t slotIx = groupIx * GroupWidth + SysCore::CountTrailingZeros( match );
+				if ( slots[ slotIx ].key == key ) {
+					return slotIx;
+				}
+				match &= ( match - 1 );
+			}
+
+			if ( MatchByte( group, CtrlEmpty ) != 0 ) {
+				return capacity;
+			}
+			groupIx = ( groupIx + step ) & GroupMask();
+		}
+		return capacity;
+	}
+
+	// First empty or deleted slot along the key's probe sequence
+	inline uint32_t FindFreeIndex( const uint64_t hash ) const
+	{
+		uint32_t groupIx = FirstGroup( hash );
+		for ( uint32_t step = 1; ; ++step )
+		{
+			const uint32_t freeMask = MatchFree( ctrl + groupIx * GroupWidth );
+			if ( freeMask != 0 ) {
+				return groupIx * GroupWidth + SysCore::CountTrailingZeros( freeMask );
+			}
+			groupIx = ( groupIx + step ) & GroupMask();
+		}
+	}
+
+	inline void DestroySlots()
+	{
+		if constexpr ( IsTrivial == false )
+		{
+			for ( uint32_t i = 0; i < capacity; ++i )
+			{
+				if ( ( ctrl[ i ] & 0x80 ) == 0 ) {
+					slots[ i ].~slot_t();
+				}
+			}
+		}
+	}
+
+	inline void Deallocate()
+	{
+		if ( capacity == 0 ) {
+			return;
+		}
+		SlotTraits::deallocate( slotAllocator, slots, capacity );
+		CtrlTraits::deallocate( ctrlAllocator, ctrl, capacity );
+		slots = nullptr;
+		ctrl = nullptr;
+		capacity = 0;
+		growthLeft = 0;
+	}
+
+	inline void Rehash( const uint32_t newCapacity )
+	{
+		uint8_t* oldCtrl = ctrl;
+		slot_t* oldSlots = slots;
+		const uint32_t oldCapacity = capacity;
+
+		ctrl = CtrlTraits::allocate( ctrlAllocator, newCapacity );
+		slots = SlotTraits::allocate( slotAllocator, newCapacity );
+		capacity = newCapacity;
+		memset( ctrl, CtrlEmpty, newCapacity );
+
+		for ( uint32_t i = 0; i < oldCapacity; ++i )
+		{
+			if ( ( oldCtrl[ i ] & 0x80 ) != 0 ) {
+				continue;
+			}
+			slot_t& oldSlot = oldSlots[ i ];
+			const uint64_t hash = hasher( oldSlot.key );
+			const uint32_t slotIx = FindFreeIndex( hash );
+			ctrl[ slotIx ] = Tag( hash );
+			new ( &slots[ slotIx ] ) slot_t{ std::move( oldSlot.key ), std::move( oldSlot.value ) };
+			oldSlot.~slot_t();
+		}
+		growthLeft = MaxLoad( newCapacity ) - count;
+
+		if ( oldCapacity > 0 )
+		{
+			SlotTraits::deallocate( slotAllocator, oldSlots, oldCapacity );
+			CtrlTraits::deallocate( ctrlAllocator, oldCtrl, oldCapacity );
+		}
+	}
+
+	static inline uint32_t CapacityFor( const uint32_t elementCount )
+	{
+		uint32_t newCapacity = MinCapacity;
+		while ( MaxLoad( newCapacity ) < elementCount ) {
+			newCapacity *= 2;
+		}
+		return newCapacity;
+	}
+
+	// Returns the slot for key, claiming and constructing it when absent
+	template<typename... Args>
+	inline std::pair<uint32_t, bool> FindOrInsert( const K& key, Args&&... args )
+	{
+		const uint64_t hash = hasher( key );
+		const uint32_t found = FindIndex( key, hash );
+		if ( found != capacity ) {
+			return std::make_pair( found, false );
+		}
+
+		uint32_t slotIx = ( capacity > 0 ) ? FindFreeIndex( hash ) : 0;
+		if ( ( capacity == 0 ) || ( ( growthLeft == 0 ) && ( ctrl[ slotIx ] == CtrlEmpty ) ) )
+		{
+			// The key or arguments may refer into the map, so build the entry
+			// before the rehash frees the old slots
+			slot_t entry{ key, V( std::forward<Args>( args )... ) };
+
+			// Rehashing in place when tombstones are the problem, growing otherwise
+			const uint32_t newCapacity = ( capacity == 0 ) ? MinCapacity : ( ( count + 1 > MaxLoad( capacity ) / 2 ) ? 2 * capacity : capacity );
+			Rehash( newCapacity );
+			slotIx = FindFreeIndex( hash );
+			ClaimSlot( slotIx, hash );
+			new ( &slots[ slotIx ] ) slot_t{ std::move( entry.key ), std::move( entry.value ) };
+			return std::make_pair( slotIx, true );
+		}
+
+		ClaimSlot( slotIx, hash );
+		new ( &slots[ slotIx ] ) slot_t{ key, V( std::forward<Args>( args )... ) };
+		return std::make_pair( slotIx, true );
+	}
+
+	inline void ClaimSlot( const uint32_t slotIx, const uint64_t hash )
+	{
+		if ( ctrl[ slotIx ] == CtrlEmpty ) {
+			--growthLeft;
+		}
+		ctrl[ slotIx ] = Tag( hash );
+		++count;
+	}
+
+	inline void CopyFrom( const HashMap& rhs )
+	{
+		Reserve( rhs.count );
+		rhs.ForEach( [&]( const K& key, const V& value ) {
+			FindOrInsert( key, value );
+		} );
+	}
+
+public:
+
+	HashMap( const Allocator& allocator = Allocator() )
+		: ctrl( nullptr ), slots( nullptr ), capacity( 0 ), count( 0 ), growthLeft( 0 ),
+		slotAllocator( allocator ), ctrlAllocator( allocator )
+	{}
+
+	HashMap( const HashMap& rhs )
+		: ctrl( nullptr ), slots( nullptr ), capacity( 0 ), count( 0 ), growthLeft( 0 ), hasher( rhs.hasher ),
+		slotAllocator( SlotTraits::select_on_container_copy_construction( rhs.slotAllocator ) ),
+		ctrlAllocator( CtrlTraits::select_on_container_copy_construction( rhs.ctrlAllocator ) )
+	{
+		CopyFrom( rhs );
+	}
+
+	HashMap( HashMap&& rhs ) noexcept
+		: ctrl( rhs.ctrl ), slots( rhs.slots ), capacity( rhs.capacity ), count( rhs.count ), growthLeft( rhs.growthLeft ),
+		hasher( std::move( rhs.hasher ) ), slotAllocator( std::move( rhs.slotAllocator ) ), ctrlAllocator( std::move( rhs.ctrlAllocator ) )
+	{
+		rhs.ctrl = nullptr;
+		rhs.slots = nullptr;
+		rhs.capacity = 0;
+		rhs.count = 0;
+		rhs.growthLeft = 0;
+	}
+
+	~HashMap()
+	{
+		DestroySlots();
+		Deallocate();
+	}
+
+	HashMap& operator=( const HashMap& rhs )
+	{
+		if ( this != &rhs )
+		{
+			Clear();
+			CopyFrom( rhs );
+		}
+		return *this;
+	}
+
+	HashMap& operator=( HashMap&& rhs ) noexcept
+	{
+		if ( this != &rhs )
+		{
+			DestroySlots();
+			Deallocate();
+			std::swap( ctrl, rhs.ctrl );
+			std::swap( slots, rhs.slots );
+			std::swap( capacity, rhs.capacity );
+			std::swap( count, rhs.count );
+			std::swap( growthLeft, rhs.growthLeft );
+			std::swap( hasher, rhs.hasher );
+			std::swap( slotAllocator, rhs.slotAllocator );
+			std::swap( ctrlAllocator, rhs.ctrlAllocator );
+		}
+		return *this;
+	}
+
+	// Returns false when the key already exists, the stored value is left untouched
+	inline bool Insert( const K& key, const V& value )
+	{
+		return FindOrInsert( key, value ).second;
+	}
+
+	inline bool Insert( const K& key, V&& value )
+	{
+		return FindOrInsert( key, std::move( value ) ).second;
+	}
+
+	template<typename... Args>
+	inline V& Emplace( const K& key, Args&&... args )
+	{
+		return slots[ FindOrInsert( key, std::forward<Args>( args )... ).first ].value;
+	}
+
+	inline V& operator[]( const K& key )
+	{
+		return slots[ FindOrInsert( key ).first ].value;
+	}
+
+	inline V* Find( const K& key )
+	{
+		const uint32_t slotIx = FindIndex( key, hasher( key ) );
+		return ( slotIx != capacity ) ? &slots[ slotIx ].value : nullptr;
+	}
+
+	inline const V* Find( const K& key ) const
+	{
+		const uint32_t slotIx = FindIndex( key, hasher( key ) );
+		return ( slotIx != capacity ) ? &slots[ slotIx ].value : nullptr;
+	}
+
+	inline bool Contains( const K& key ) const
+	{
+		return ( FindIndex( key, hasher( key ) ) != capacity );
+	}
+
+	inline bool Erase( const K& key )
+	{
+		const uint32_t slotIx = FindIndex( key, hasher( key ) );
+		if ( slotIx == capacity ) {
+			return false;
+		}
+
+		slots[ slotIx ].~slot_t();
+		--count;
+
+		// Probes never continue past a group with an empty slot, so the
+		// slot can go straight back to empty instead of becoming a tombstone
+		const uint8_t* group = ctrl + ( slotIx / GroupWidth ) * GroupWidth;
+		if ( MatchByte( group, CtrlEmpty ) != 0 )
+		{
+			ctrl[ slotIx ] = CtrlEmpty;
+			++growthLeft;
+		}
+		else
+		{
+			ctrl[ slotIx ] = CtrlDeleted;
+		}
+		return true;
+	}
+
+	// Keeps the allocation, only the control bytes are rewritten for trivial types
+	inline void Clear()
+	{
+		if ( capacity > 0 )
+		{
+			DestroySlots();
+			memset( ctrl, CtrlEmpty, capacity );
+		}
+		count = 0;
+		growthLeft = MaxLoad( capacity );
+	}
+
+	inline void Reserve( const uint32_t elementCount )
+	{
+		const uint32_t newCapacity = CapacityFor( elementCount );
+		if ( newCapacity > capacity ) {
+			Rehash( newCapacity );
+		}
+	}
+
+	template<typename Func>
+	inline void ForEach( Func&& func )
+	{
+		for ( uint32_t i = 0; i < capacity; ++i )
+		{
+			if ( ( ctrl[ i ] & 0x80 ) == 0 ) {
+				func( static_cast<const K&>( slots[ i ].key ), slots[ i ].value );
+			}
+		}
+	}
+
+	template<typename Func>
+	inline void ForEach( Func&& func ) const
+	{
+		for ( uint32_t i = 0; i < capacity; ++i )
+		{
+			if ( ( ctrl[ i ] & 0x80 ) == 0 ) {
+				func( static_cast<const K&>( slots[ i ].key ), static_cast<const V&>( slots[ i ].value ) );
+			}
+		}
+	}
+
+	inline uint32_t Count() const
+	{
+		return count;
+	}
+
+	inline uint32_t Capacity() const
+	{
+		return capacity;
+	}
+};
+}
@@ -0,0 +1,91 @@
+#include "intrusivePtr.h"
+
+#include <thread>
+#include <vector>
+
+static int intrusiveTestLive = 0;
+
+struct intrusiveTestObject_t : public RefCounted<intrusiveTestObject_t>
+{
+    int value;
+
+    intrusiveTestObject_t( const int _value ) : value( _value ) { ++intrusiveTestLive; }
+    ~intrusiveTestObject_t() { --intrusiveTestLive; }
+};
+
+struct intrusiveTestShared_t : public RefCounted<intrusiveTestShared_t, atomicRefCount_t>
+{
+    int value;
+
+    intrusiveTestShared_t( const int _value ) : value( _value ) { ++intrusiveTestLive; }
+    ~intrusiveTestShared_t() { --intrusiveTestLive; }
+};
+
+struct intrusiveTestPooled_t : public RefCounted<intrusiveTestPooled_t, refCount_t, poolDeleter_t<intrusiveTestPooled_t>>
+{
+    int value;
+
+    intrusiveTestPooled_t( const int _value ) : value( _value ) { ++intrusiveTestLive; }
+    ~intrusiveTestPooled_t() { --intrusiveTestLive; }
+};
+
+
+void TestIntrusivePtr()
+{
+    static_assert( sizeof( intrusivePtr_t<intrusiveTestObject_t> ) == sizeof( void* ) );
+    static_assert( sizeof( intrusiveTestObject_t ) == sizeof( refCount_t ) + sizeof( int ) );
+
+    // --- Adopt, copy, move, release ---
+    {
+        intrusivePtr_t<intrusiveTestObject_t> a = MakeIntrusive<intrusiveTestObject_t>( 3 );
+        assert( a->value == 3 && ( *a ).value == 3 );
+
+        intrusivePtr_t<intrusiveTestObject_t> b = a;
+        intrusivePtr_t<intrusiveTestObject_t> c( std::move( b ) );
+        assert( !b.IsValid() && c == a );
+
+        a.Release();
+        assert( intrusiveTestLive == 1 );
+
+        // Raw pointers can be turned back into owners
+        intrusivePtr_t<intrusiveTestObject_t> d = intrusivePtr_t<intrusiveTestObject_t>::Retain( c.Get() );
+        c = intrusivePtr_t<intrusiveTestObject_t>();
+        assert( d->value == 3 );
+        assert( intrusiveTestLive == 1 );
+    }
+    assert( intrusiveTestLive == 0 );
+
+    // --- Atomic count across threads ---
+    {
+        intrusivePtr_t<intrusiveTestShared_t> shared = MakeIntrusive<intrusiveTestShared_t>( 5 );
+        std::vector<std::thread> threads;
+        for ( uint32_t t = 0; t < 4; ++t )
+        {
+            threads.emplace_back( [&]() {
+                for ( uint32_t i = 0; i < 10000; ++i )
+                {
+                    intrusivePtr_t<intrusiveTestShared_t> copy = shared;
+                    assert( copy->value == 5 );
+                }
+            } );
+        }
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+        assert( intrusiveTestLive == 1 );
+    }
+    assert( intrusiveTestLive == 0 );
+
+    // --- Pool deleter returns blocks to the pool ---
+    {
+        SysCore::ObjectPool<intrusiveTestPooled_t> pool;
+        {
+            intrusivePtr_t<intrusiveTestPooled_t> a = MakePooled( pool, 7 );
+            intrusivePtr_t<intrusiveTestPooled_t> b = a;
+            assert( pool.Stats().liveCount == 1 );
+            assert( b->value == 7 );
+        }
+        assert( intrusiveTestLive == 0 );
+        assert( pool.Stats().liveCount == 0 );
+    }
+}
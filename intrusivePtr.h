@@ -0,0 +1,196 @@
+#pragma once
+
+#include "objectPool.h"
+#include "refCounter.h"
+#include <assert.h>
+#include <cstdint>
+#include <utility>
+
+void TestIntrusivePtr();
+
+template<typename T>
+struct defaultDeleter_t
+{
+	void operator()( T* obj ) const {
+		delete obj;
+	}
+};
+
+// Returns objects to the ObjectPool they were taken from, see MakePooled()
+template<typename T>
+struct poolDeleter_t
+{
+	SysCore::ObjectPool<T>* pool = nullptr;
+
+	void operator()( T* obj ) const {
+		// Copy out first, deleting the object also destroys this deleter
+		SysCore::ObjectPool<T>* owner = pool;
+		assert( owner != nullptr );
+		owner->Delete( obj );
+	}
+};
+
+// Mixin that stores the reference count inside the object itself:
+//   class Mesh : public RefCounted<Mesh> { ... };
+// Objects start with one reference, which the first intrusivePtr_t adopts.
+// The deleter is stored in the object too, empty deleters take no space
+template<typename Derived, typename RefCount = typename refCountPolicy_t<Derived>::type, typename Deleter = defaultDeleter_t<Derived>>
+class RefCounted : private Deleter
+{
+public:
+	RefCounted() : refCount( 1 )
+	{}
+
+	// A copy is a new object with its own count
+	RefCounted( const RefCounted& rhs ) : Deleter( rhs ), refCount( 1 )
+	{}
+
+	RefCounted& operator=( const RefCounted& ) {
+		return *this;
+	}
+
+	void AddRef() const {
+		refCount.Add();
+	}
+
+	void ReleaseRef() const
+	{
+		if ( refCount.Release() == 0 )
+		{
+			Deleter deleter = *this;
+			deleter( const_cast<Derived*>( static_cast<const Derived*>( this ) ) );
+		}
+	}
+
+	void SetDeleter( const Deleter& deleter ) {
+		static_cast<Deleter&>( *this ) = deleter;
+	}
+
+protected:
+	~RefCounted() = default;
+
+private:
+	mutable RefCount refCount;
+};
+
+// One-pointer smart pointer for RefCounted types. Access is a single
+// dereference, there is no separate control block to check
+template<typename T>
+class intrusivePtr_t
+{
+public:
+	intrusivePtr_t()
+	{
+		this->object = nullptr;
+	}
+
+	// Adopts the reference a new object is created with
+	explicit intrusivePtr_t( T* obj )
+	{
+		this->object = obj;
+	}
+
+	intrusivePtr_t( const intrusivePtr_t& handle )
+	{
+		this->object = handle.object;
+		if ( IsValid() ) {
+			this->object->AddRef();
+		}
+	}
+
+	intrusivePtr_t( intrusivePtr_t&& handle ) noexcept
+	{
+		this->object = handle.object;
+		handle.object = nullptr;
+	}
+
+	~intrusivePtr_t()
+	{
+		Release();
+	}
+
+	intrusivePtr_t& operator=( const intrusivePtr_t& handle )
+	{
+		if ( this != &handle )
+		{
+			if ( handle.IsValid() ) {
+				handle.object->AddRef();
+			}
+			Release();
+			this->object = handle.object;
+		}
+		return *this;
+	}
+
+	intrusivePtr_t& operator=( intrusivePtr_t&& handle ) noexcept
+	{
+		if ( this != &handle )
+		{
+			Release();
+			this->object = handle.object;
+			handle.object = nullptr;
+		}
+		return *this;
+	}
+
+	// Takes an additional reference to an object that is already owned elsewhere
+	static intrusivePtr_t Retain( T* obj )
+	{
+		if ( obj != nullptr ) {
+			obj->AddRef();
+		}
+		return intrusivePtr_t( obj );
+	}
+
+	bool operator==( const intrusivePtr_t& rhs ) const {
+		return ( object == rhs.object );
+	}
+
+	bool operator!=( const intrusivePtr_t& rhs ) const {
+		return ( object != rhs.object );
+	}
+
+	T* operator->() const {
+		assert( IsValid() );
+		return object;
+	}
+
+	T& operator*() const {
+		assert( IsValid() );
+		return *object;
+	}
+
+	void Release()
+	{
+		if ( IsValid() )
+		{
+			object->ReleaseRef();
+			object = nullptr;
+		}
+	}
+
+	bool IsValid() const {
+		return ( object != nullptr );
+	}
+
+	T* Get() const {
+		return object;
+	}
+private:
+	T*	object;
+};
+
+template<typename T, typename... Args>
+intrusivePtr_t<T> MakeIntrusive( Args&&... args )
+{
+	return intrusivePtr_t<T>( new T( std::forward<Args>( args )... ) );
+}
+
+// T must use poolDeleter_t<T> as its RefCounted deleter
+template<typename T, typename... Args>
+intrusivePtr_t<T> MakePooled( SysCore::ObjectPool<T>& pool, Args&&... args )
+{
+	T* obj = pool.New( std::forward<Args>( args )... );
+	obj->SetDeleter( poolDeleter_t<T>{ &pool } );
+	return intrusivePtr_t<T>( obj );
+}
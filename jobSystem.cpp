@@ -0,0 +1,576 @@
+#include "jobSystem.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#include "timer.h"
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace SysCore
+{
+static const uint32_t NoCore = ~0u;
+
+struct currentWorker_t
+{
+	const JobSystem*	system = nullptr;
+	uint32_t			index = JobSystem::NoWorker;
+};
+
+static thread_local currentWorker_t currentWorker;
+static thread_local uint32_t stealRandom = 0;
+
+
+static uint32_t NextVictim( const uint32_t count )
+{
+	// xorshift32, seeded per thread from its address so threads start apart
+	uint32_t x = stealRandom;
+	if ( x == 0 ) {
+		x = static_cast<uint32_t>( reinterpret_cast<uintptr_t>( &stealRandom ) >> 4 ) | 1;
+	}
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	stealRandom = x;
+	return x % count;
+}
+
+
+static void PinCurrentThread( const uint32_t core )
+{
+#if defined( _WIN32 )
+	if ( core < 64 ) {
+		SetThreadAffinityMask( GetCurrentThread(), static_cast<DWORD_PTR>( 1 ) << core );
+	}
+#elif defined( __linux__ )
+	cpu_set_t set;
+	CPU_ZERO( &set );
+	CPU_SET( core, &set );
+	pthread_setaffinity_np( pthread_self(), sizeof( set ), &set );
+#else
+	( void )core;
+#endif
+}
+
+
+static inline void Increment( std::atomic<uint64_t>& counter )
+{
+	counter.store( counter.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+}
+
+
+JobSystem::JobSystem( const jobSystemConfig_t& config )
+	: jobPool( sizeof( job_t ), alignof( job_t ) ), wakeSignal( 0 ), sleepers( 0 ), running( true )
+{
+	const uint32_t coreCount = std::max( 1u, std::thread::hardware_concurrency() );
+	const uint32_t workerCount = ( config.workerCount == jobSystemConfig_t::AutoWorkerCount ) ? ( coreCount - 1 ) : config.workerCount;
+
+	// Every deque must exist before any worker starts stealing
+	workers.reserve( workerCount );
+	for ( uint32_t i = 0; i < workerCount; ++i )
+	{
+		std::unique_ptr<worker_t> worker = std::make_unique<worker_t>();
+		worker->executed.store( 0, std::memory_order_relaxed );
+		worker->stolen.store( 0, std::memory_order_relaxed );
+		worker->sleeps.store( 0, std::memory_order_relaxed );
+		workers.push_back( std::move( worker ) );
+	}
+
+	for ( uint32_t i = 0; i < workerCount; ++i )
+	{
+		const uint32_t core = config.pinWorkers ? ( ( config.firstCore + i ) % coreCount ) : NoCore;
+		workers[ i ]->thread = std::thread( &JobSystem::WorkerMain, this, i, core );
+	}
+}
+
+
+JobSystem::~JobSystem()
+{
+	running.store( false, std::memory_order_seq_cst );
+	wakeSignal.fetch_add( 1, std::memory_order_seq_cst );
+	AtomicWakeAll( &wakeSignal );
+
+	for ( std::unique_ptr<worker_t>& worker : workers ) {
+		worker->thread.join();
+	}
+
+	// Only reachable with no workers, or jobs submitted while shutting down
+	job_t* job;
+	while ( sharedQueue.TryPop( job ) ) {
+		Execute( job, NoWorker );
+	}
+}
+
+
+uint32_t JobSystem::WorkerIndex() const
+{
+	return ( currentWorker.system == this ) ? currentWorker.index : NoWorker;
+}
+
+
+void JobSystem::WorkerMain( const uint32_t workerIx, const uint32_t core )
+{
+	currentWorker.system = this;
+	currentWorker.index = workerIx;
+
+	if ( core != NoCore ) {
+		PinCurrentThread( core );
+	}
+
+	worker_t& worker = *workers[ workerIx ];
+	SpinBackoff backoff;
+	for ( ;; )
+	{
+		job_t* job;
+		if ( FindJob( workerIx, job ) )
+		{
+			Execute( job, workerIx );
+			backoff.Reset();
+			continue;
+		}
+
+		if ( running.load( std::memory_order_acquire ) == false ) {
+			break;
+		}
+
+		if ( backoff.Spin() ) {
+			continue;
+		}
+
+		Sleep();
+		Increment( worker.sleeps );
+		backoff.Reset();
+	}
+
+	currentWorker = currentWorker_t();
+}
+
+
+void JobSystem::Enqueue( job_t* job )
+{
+	const uint32_t workerIx = WorkerIndex();
+	const bool queued = ( workerIx != NoWorker ) ? workers[ workerIx ]->deque.Push( job ) : sharedQueue.TryPush( job );
+	if ( queued == false )
+	{
+		Execute( job, workerIx );
+		return;
+	}
+
+	// A worker about to sleep either sees the bumped signal or the queued job
+	wakeSignal.fetch_add( 1, std::memory_order_seq_cst );
+	if ( sleepers.load( std::memory_order_seq_cst ) != 0 ) {
+		AtomicWakeOne( &wakeSignal );
+	}
+}
+
+
+bool JobSystem::FindJob( const uint32_t workerIx, job_t*& outJob )
+{
+	if ( ( workerIx != NoWorker ) && workers[ workerIx ]->deque.Pop( outJob ) ) {
+		return true;
+	}
+
+	bool found = sharedQueue.TryPop( outJob );
+
+	const uint32_t workerCount = WorkerCount();
+	if ( ( found == false ) && ( workerCount > 0 ) )
+	{
+		const uint32_t start = NextVictim( workerCount );
+		for ( uint32_t i = 0; ( i < workerCount ) && ( found == false ); ++i )
+		{
+			const uint32_t victim = ( start + i ) % workerCount;
+			found = ( victim != workerIx ) && workers[ victim ]->deque.Steal( outJob );
+		}
+	}
+
+	if ( found && ( workerIx != NoWorker ) ) {
+		Increment( workers[ workerIx ]->stolen );
+	}
+	return found;
+}
+
+
+bool JobSystem::HasWork() const
+{
+	if ( sharedQueue.Count() > 0 ) {
+		return true;
+	}
+	for ( const std::unique_ptr<worker_t>& worker : workers )
+	{
+		if ( worker->deque.Count() > 0 ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void JobSystem::Execute( job_t* job, const uint32_t workerIx )
+{
+	JobCounter* counter = job->counter;
+	job->invoke( job );
+	jobPool.Free( job );
+
+	if ( workerIx != NoWorker ) {
+		Increment( workers[ workerIx ]->executed );
+	}
+
+	// Last touch of the counter, a waiter may destroy it as soon as this lands
+	counter->pending.fetch_sub( 1, std::memory_order_acq_rel );
+}
+
+
+void JobSystem::Sleep()
+{
+	const uint32_t observed = wakeSignal.load( std::memory_order_seq_cst );
+	sleepers.fetch_add( 1, std::memory_order_seq_cst );
+	if ( running.load( std::memory_order_seq_cst ) && ( HasWork() == false ) ) {
+		AtomicWait( &wakeSignal, observed );
+	}
+	sleepers.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+
+bool JobSystem::RunOne()
+{
+	const uint32_t workerIx = WorkerIndex();
+	job_t* job;
+	if ( FindJob( workerIx, job ) == false ) {
+		return false;
+	}
+	Execute( job, workerIx );
+	return true;
+}
+
+
+void JobSystem::Wait( JobCounter& counter )
+{
+	SpinBackoff backoff;
+	while ( counter.IsDone() == false )
+	{
+		if ( RunOne() )
+		{
+			backoff.Reset();
+			continue;
+		}
+
+		// Nothing to help with, the remaining jobs are running elsewhere
+		if ( backoff.Spin() == false ) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+
+std::vector<jobWorkerStats_t> JobSystem::Stats() const
+{
+	std::vector<jobWorkerStats_t> stats;
+	stats.reserve( workers.size() );
+	for ( const std::unique_ptr<worker_t>& worker : workers )
+	{
+		stats.push_back( { worker->executed.load( std::memory_order_relaxed ),
+			worker->stolen.load( std::memory_order_relaxed ),
+			worker->sleeps.load( std::memory_order_relaxed ) } );
+	}
+	return stats;
+}
+
+
+static uint64_t FibSerial( const uint32_t n )
+{
+	return ( n < 2 ) ? n : ( FibSerial( n - 1 ) + FibSerial( n - 2 ) );
+}
+
+
+// Spawns one job per branch down to the cutoff, waiting on children from inside a job
+static void FibJob( JobSystem& jobs, const uint32_t n, const uint32_t cutoff, uint64_t* result )
+{
+	if ( n <= cutoff )
+	{
+		*result = FibSerial( n );
+		return;
+	}
+
+	uint64_t left = 0;
+	uint64_t right = 0;
+	JobCounter counter;
+	jobs.Submit( counter, [&jobs, n, cutoff, &left]() { FibJob( jobs, n - 1, cutoff, &left ); } );
+	FibJob( jobs, n - 2, cutoff, &right );
+	jobs.Wait( counter );
+	*result = left + right;
+}
+
+
+void TestJobSystem()
+{
+    // --- Deque order on one thread ---
+    {
+        WorkStealingDeque<uint32_t, 8> deque;
+        uint32_t value = 0;
+        assert( !deque.Pop( value ) && !deque.Steal( value ) );
+
+        for ( uint32_t i = 0; i < 8; ++i ) {
+            assert( deque.Push( i ) );
+        }
+        assert( !deque.Push( 8 ) );
+        assert( deque.Count() == 8 );
+
+        assert( deque.Pop( value ) && ( value == 7 ) );
+        assert( deque.Steal( value ) && ( value == 0 ) );
+        assert( deque.Steal( value ) && ( value == 1 ) );
+        assert( deque.Pop( value ) && ( value == 6 ) );
+        assert( deque.Count() == 4 );
+
+        // Wraps around the ring
+        for ( uint32_t i = 8; i < 12; ++i ) {
+            assert( deque.Push( i ) );
+        }
+        assert( !deque.Push( 12 ) );
+        for ( uint32_t expected = 2; expected < 6; ++expected ) {
+            assert( deque.Steal( value ) && ( value == expected ) );
+        }
+        for ( uint32_t expected = 11; expected >= 8; --expected ) {
+            assert( deque.Pop( value ) && ( value == expected ) );
+        }
+        assert( !deque.Pop( value ) );
+    }
+
+    // --- Owner and thieves take every element exactly once ---
+    {
+        const uint32_t itemCount = 200000;
+        WorkStealingDeque<uint32_t, 256> deque;
+        std::vector<std::atomic<uint32_t>> seen( itemCount );
+        for ( std::atomic<uint32_t>& s : seen ) {
+            s.store( 0, std::memory_order_relaxed );
+        }
+        std::atomic<bool> done( false );
+
+        std::vector<std::thread> thieves;
+        for ( uint32_t t = 0; t < 3; ++t )
+        {
+            thieves.emplace_back( [&]() {
+                uint32_t value;
+                while ( !done.load( std::memory_order_acquire ) || ( deque.Count() > 0 ) )
+                {
+                    if ( deque.Steal( value ) ) {
+                        seen[ value ].fetch_add( 1, std::memory_order_relaxed );
+                    }
+                }
+            } );
+        }
+
+        uint32_t value;
+        for ( uint32_t i = 0; i < itemCount; ++i )
+        {
+            while ( !deque.Push( i ) )
+            {
+                if ( deque.Pop( value ) ) {
+                    seen[ value ].fetch_add( 1, std::memory_order_relaxed );
+                }
+            }
+            if ( ( ( i % 3 ) == 0 ) && deque.Pop( value ) ) {
+                seen[ value ].fetch_add( 1, std::memory_order_relaxed );
+            }
+        }
+        while ( deque.Pop( value ) ) {
+            seen[ value ].fetch_add( 1, std::memory_order_relaxed );
+        }
+        done.store( true, std::memory_order_release );
+        for ( std::thread& thief : thieves ) {
+            thief.join();
+        }
+
+        for ( uint32_t i = 0; i < itemCount; ++i ) {
+            assert( seen[ i ].load( std::memory_order_relaxed ) == 1 );
+        }
+    }
+
+    // --- Fan-out from outside the pool ---
+    {
+        jobSystemConfig_t config;
+        config.workerCount = 3;
+        JobSystem jobs( config );
+        assert( jobs.WorkerCount() == 3 );
+        assert( jobs.WorkerIndex() == JobSystem::NoWorker );
+
+        // Jobs the caller runs, while waiting or because a queue was full, aren't in the stats
+        std::atomic<uint64_t> sum( 0 );
+        std::atomic<uint32_t> onCaller( 0 );
+        JobCounter counter;
+        for ( uint32_t i = 1; i <= 10000; ++i )
+        {
+            jobs.Submit( counter, [&jobs, &sum, &onCaller, i]() {
+                sum.fetch_add( i, std::memory_order_relaxed );
+                if ( jobs.WorkerIndex() == JobSystem::NoWorker ) {
+                    onCaller.fetch_add( 1, std::memory_order_relaxed );
+                }
+            } );
+        }
+        jobs.Wait( counter );
+        assert( counter.IsDone() );
+        assert( sum.load() == ( 10000ull * 10001ull ) / 2 );
+
+        // Counters are reusable, and jobs see their worker index
+        std::atomic<uint32_t> onWorker( 0 );
+        std::atomic<uint32_t> ran( 0 );
+        auto job = [&]() {
+            const uint32_t workerIx = jobs.WorkerIndex();
+            if ( workerIx != JobSystem::NoWorker )
+            {
+                assert( workerIx < jobs.WorkerCount() );
+                onWorker.fetch_add( 1, std::memory_order_relaxed );
+            }
+            else
+            {
+                onCaller.fetch_add( 1, std::memory_order_relaxed );
+            }
+            ran.fetch_add( 1, std::memory_order_relaxed );
+        };
+
+        // Without the caller helping, only a worker can run it
+        jobs.Submit( counter, job );
+        while ( counter.IsDone() == false ) {
+            std::this_thread::yield();
+        }
+        assert( onWorker.load() == 1 );
+
+        for ( uint32_t i = 1; i < 1000; ++i ) {
+            jobs.Submit( counter, job );
+        }
+        jobs.Wait( counter );
+        assert( ran.load() == 1000 );
+
+        uint64_t executed = 0;
+        for ( const jobWorkerStats_t& stats : jobs.Stats() ) {
+            executed += stats.executed;
+        }
+        assert( executed + onCaller.load() == 11000 );
+        assert( onWorker.load() >= 1 );
+    }
+
+    // --- Nested jobs wait by helping ---
+    {
+        JobSystem jobs;
+        uint64_t result = 0;
+        JobCounter counter;
+        jobs.Submit( counter, [&jobs, &result]() { FibJob( jobs, 24, 8, &result ); } );
+        jobs.Wait( counter );
+        assert( result == FibSerial( 24 ) );
+    }
+
+    // --- No workers, the waiting thread runs everything ---
+    {
+        jobSystemConfig_t config;
+        config.workerCount = 0;
+        JobSystem jobs( config );
+        uint64_t result = 0;
+        FibJob( jobs, 20, 4, &result );
+        assert( result == FibSerial( 20 ) );
+    }
+
+    // --- Several submitting threads, pinned workers ---
+    {
+        jobSystemConfig_t config;
+        config.workerCount = 2;
+        config.pinWorkers = true;
+        JobSystem jobs( config );
+
+        std::atomic<uint32_t> ran( 0 );
+        std::vector<std::thread> producers;
+        for ( uint32_t t = 0; t < 3; ++t )
+        {
+            producers.emplace_back( [&]() {
+                JobCounter counter;
+                for ( uint32_t i = 0; i < 5000; ++i ) {
+                    jobs.Submit( counter, [&ran]() { ran.fetch_add( 1, std::memory_order_relaxed ); } );
+                }
+                jobs.Wait( counter );
+            } );
+        }
+        for ( std::thread& producer : producers ) {
+            producer.join();
+        }
+        assert( ran.load() == 15000 );
+    }
+}
+
+
+// Deterministic busy work so the compiler can't drop it
+static uint64_t Spin( const uint32_t iterations, uint64_t seed )
+{
+    for ( uint32_t i = 0; i < iterations; ++i ) {
+        seed = ( seed * 6364136223846793005ull ) + 1442695040888963407ull;
+    }
+    return seed;
+}
+
+
+void BenchmarkJobSystem()
+{
+    const uint32_t jobCount = 8192;
+    const uint32_t coreCount = std::max( 2u, std::thread::hardware_concurrency() );
+
+    // Uneven jobs: every 64th one is 64x the work, a static split would leave threads idle
+    auto jobCost = []( const uint32_t i ) { return ( ( i % 64 ) == 0 ) ? 64 * 2000u : 2000u; };
+
+    uint64_t serialUs = 1;
+    {
+        std::vector<uint64_t> results( jobCount );
+        Timer timer( "Serial", timerPrecision_t::MICROSECOND );
+        for ( uint32_t i = 0; i < jobCount; ++i ) {
+            results[ i ] = Spin( jobCost( i ), i );
+        }
+        timer.Stop();
+        serialUs = std::max<uint64_t>( 1, timer.GetElapsed() );
+        std::cout << "Uneven fan-out serial: " << serialUs << "us" << std::endl;
+    }
+
+    for ( uint32_t threadCount = 1; threadCount <= coreCount; threadCount *= 2 )
+    {
+        jobSystemConfig_t config;
+        config.workerCount = threadCount - 1;
+        JobSystem jobs( config );
+
+        std::vector<uint64_t> results( jobCount );
+        Timer timer( "JobSystem", timerPrecision_t::MICROSECOND );
+        JobCounter counter;
+        for ( uint32_t i = 0; i < jobCount; ++i ) {
+            jobs.Submit( counter, [&results, &jobCost, i]() { results[ i ] = Spin( jobCost( i ), i ); } );
+        }
+        jobs.Wait( counter );
+        timer.Stop();
+        const uint64_t elapsedUs = std::max<uint64_t>( 1, timer.GetElapsed() );
+
+        uint64_t stolen = 0;
+        for ( const jobWorkerStats_t& stats : jobs.Stats() ) {
+            stolen += stats.stolen;
+        }
+        std::cout << "Uneven fan-out " << threadCount << " threads: " << elapsedUs << "us, "
+            << ( static_cast<double>( serialUs ) / elapsedUs ) << "x serial, " << stolen << " steals" << std::endl;
+    }
+
+    // Recursive spawning: measures scheduling overhead more than the work itself
+    for ( uint32_t threadCount = 1; threadCount <= coreCount; threadCount *= 2 )
+    {
+        jobSystemConfig_t config;
+        config.workerCount = threadCount - 1;
+        JobSystem jobs( config );
+
+        const uint32_t n = 30;
+        const uint32_t cutoff = 12;
+        uint64_t result = 0;
+        Timer timer( "Fib", timerPrecision_t::MICROSECOND );
+        FibJob( jobs, n, cutoff, &result );
+        timer.Stop();
+        assert( result == FibSerial( n ) );
+        std::cout << "Recursive fib(" << n << ") " << threadCount << " threads: " << timer.GetElapsed() << "us" << std::endl;
+    }
+}
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <assert.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+#include "mpmcQueue.h"
+#include "objectPool.h"
+#include "spinlock.h"
+
+namespace SysCore
+{
+void TestJobSystem();
+void BenchmarkJobSystem();
+
+// Chase-Lev work-stealing deque with a fixed capacity. The owner pushes and
+// pops at the bottom without contention; thieves take from the top, so they
+// get the oldest (usually largest) work. Owner and thieves only race on the
+// last element, which is settled with a CAS on top.
+template<class T, uint32_t N>
+class WorkStealingDeque
+{
+private:
+	static_assert( ( N > 1 ) && ( ( N & ( N - 1 ) ) == 0 ), "WorkStealingDeque capacity must be a power of two" );
+	static_assert( std::is_trivially_copyable_v<T>, "WorkStealingDeque elements must be trivially copyable" );
+
+	static constexpr int64_t Mask = N - 1;
+
+	alignas( CACHE_LINE_SIZE ) std::atomic<int64_t>	top;
+	alignas( CACHE_LINE_SIZE ) std::atomic<int64_t>	bottom;
+	alignas( CACHE_LINE_SIZE ) std::atomic<T>		cells[ N ];
+
+public:
+	WorkStealingDeque() : top( 0 ), bottom( 0 )
+	{}
+
+	WorkStealingDeque( const WorkStealingDeque& ) = delete;
+	WorkStealingDeque& operator=( const WorkStealingDeque& ) = delete;
+
+	// Owner only. Returns false when full
+	inline bool Push( const T element )
+	{
+		const int64_t b = bottom.load( std::memory_order_relaxed );
+		const int64_t t = top.load( std::memory_order_acquire );
+		if ( ( b - t ) >= static_cast<int64_t>( N ) ) {
+			return false;
+		}
+		cells[ b & Mask ].store( element, std::memory_order_release );
+		bottom.store( b + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Owner only, takes the newest element
+	inline bool Pop( T& outElement )
+	{
+		const int64_t b = bottom.load( std::memory_order_relaxed ) - 1;
+		bottom.store( b, std::memory_order_seq_cst );
+		int64_t t = top.load( std::memory_order_seq_cst );
+
+		if ( t > b )
+		{
+			bottom.store( b + 1, std::memory_order_relaxed );
+			return false;
+		}
+
+		outElement = cells[ b & Mask ].load( std::memory_order_relaxed );
+		if ( t == b )
+		{
+			// Last element, a thief may be after it too
+			const bool won = top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+			bottom.store( b + 1, std::memory_order_relaxed );
+			return won;
+		}
+		return true;
+	}
+
+	// Any thread, takes the oldest element. Fails on empty or a lost race
+	inline bool Steal( T& outElement )
+	{
+		int64_t t = top.load( std::memory_order_seq_cst );
+		const int64_t b = bottom.load( std::memory_order_seq_cst );
+		if ( t >= b ) {
+			return false;
+		}
+
+		// May read a cell the owner is reusing, the CAS rejects that case
+		const T element = cells[ t & Mask ].load( std::memory_order_acquire );
+		if ( top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) == false ) {
+			return false;
+		}
+		outElement = element;
+		return true;
+	}
+
+	// Approximate when other threads are active
+	inline uint32_t Count() const
+	{
+		const int64_t b = bottom.load( std::memory_order_acquire );
+		const int64_t t = top.load( std::memory_order_acquire );
+		return ( b > t ) ? static_cast<uint32_t>( b - t ) : 0;
+	}
+
+	inline uint32_t Capacity() const
+	{
+		return N;
+	}
+};
+
+
+// Completion counter shared by a group of jobs. Every Submit() against it adds
+// one, every finished job removes one; JobSystem::Wait() returns at zero.
+// A counter can be reused once it has been waited on.
+class JobCounter
+{
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> pending;
+
+public:
+	JobCounter() : pending( 0 )
+	{}
+
+	JobCounter( const JobCounter& ) = delete;
+	JobCounter& operator=( const JobCounter& ) = delete;
+
+	~JobCounter()
+	{
+		assert( IsDone() );
+	}
+
+	inline bool IsDone() const
+	{
+		return ( pending.load( std::memory_order_acquire ) == 0 );
+	}
+
+	inline uint32_t Pending() const
+	{
+		return pending.load( std::memory_order_acquire );
+	}
+};
+
+
+struct jobSystemConfig_t
+{
+	static const uint32_t AutoWorkerCount = ~0u;
+
+	uint32_t	workerCount = AutoWorkerCount;	// Auto is one less than the core count, the caller is the last
+	bool		pinWorkers = false;				// Pin worker i to core ( firstCore + i ) % coreCount
+	uint32_t	firstCore = 1;
+};
+
+
+struct jobWorkerStats_t
+{
+	uint64_t	executed;	// Jobs run on this worker, including stolen ones
+	uint64_t	stolen;		// Jobs taken from another worker or the shared queue
+	uint64_t	sleeps;		// Times the worker ran out of work and slept
+};
+
+
+// Work-stealing job scheduler. Each worker owns a deque: jobs submitted from a
+// worker go to the bottom of its own deque and are popped LIFO for locality,
+// idle workers steal FIFO from the others. Jobs submitted from any other
+// thread go through a shared queue. Workers that find nothing spin briefly
+// then sleep until new work is submitted.
+//
+// Wait() never blocks while there is work: the waiting thread runs queued jobs
+// until its counter reaches zero, so jobs may submit and wait on child jobs
+// without tying up a worker.
+class JobSystem
+{
+public:
+	// Captures are stored inside the job, larger state should be captured by pointer
+	static const uint32_t MaxJobSize = 48;
+	static const uint32_t DequeCapacity = 4096;
+	static const uint32_t SharedQueueCapacity = 4096;
+
+private:
+	struct alignas( CACHE_LINE_SIZE ) job_t
+	{
+		void ( *invoke )( job_t* job );	// Runs the callable then destroys it
+		JobCounter*					counter;
+		alignas( 16 ) uint8_t		storage[ MaxJobSize ];
+	};
+
+	struct alignas( CACHE_LINE_SIZE ) worker_t
+	{
+		WorkStealingDeque<job_t*, DequeCapacity>	deque;
+		std::thread									thread;
+		// Written by the owning thread only, atomics so Stats() can read them
+		std::atomic<uint64_t>						executed;
+		std::atomic<uint64_t>						stolen;
+		std::atomic<uint64_t>						sleeps;
+	};
+
+	PoolAllocator								jobPool;
+	MpmcQueue<job_t*, SharedQueueCapacity>		sharedQueue;
+	std::vector<std::unique_ptr<worker_t>>		workers;
+
+	alignas( CACHE_LINE_SIZE ) std::atomic<uint32_t>	wakeSignal;	// Bumped on submit, idle workers sleep on it
+	alignas( CACHE_LINE_SIZE ) std::atomic<uint32_t>	sleepers;
+	std::atomic<bool>									running;
+
+	void		WorkerMain( const uint32_t workerIx, const uint32_t core );
+	void		Enqueue( job_t* job );
+	bool		FindJob( const uint32_t workerIx, job_t*& outJob );
+	bool		HasWork() const;
+	void		Execute( job_t* job, const uint32_t workerIx );
+	void		Sleep();
+
+	template<typename F>
+	static void Invoke( job_t* job )
+	{
+		F* func = reinterpret_cast<F*>( job->storage );
+		( *func )();
+		func->~F();
+	}
+
+public:
+	static const uint32_t NoWorker = ~0u;
+
+	JobSystem( const jobSystemConfig_t& config = jobSystemConfig_t() );
+	~JobSystem();
+
+	JobSystem( const JobSystem& ) = delete;
+	JobSystem& operator=( const JobSystem& ) = delete;
+
+	// Queues func() to run on any thread. The counter must outlive the job.
+	// If the target queue is full the job runs immediately on the caller
+	template<typename F>
+	void Submit( JobCounter& counter, F&& func )
+	{
+		using func_t = std::decay_t<F>;
+		static_assert( sizeof( func_t ) <= MaxJobSize, "Job captures too large, capture a pointer instead" );
+		static_assert( alignof( func_t ) <= 16, "Job captures over-aligned" );
+
+		job_t* job = static_cast<job_t*>( jobPool.Allocate() );
+		new ( job->storage ) func_t( std::forward<F>( func ) );
+		job->invoke = &Invoke<func_t>;
+		job->counter = &counter;
+
+		counter.pending.fetch_add( 1, std::memory_order_relaxed );
+		Enqueue( job );
+	}
+
+	// Runs queued jobs on the calling thread until the counter reaches zero
+	void		Wait( JobCounter& counter );
+
+	// Runs at most one queued job on the calling thread, returns false if none was found
+	bool		RunOne();
+
+	// Index of the calling worker in this system, NoWorker for any other thread
+	uint32_t	WorkerIndex() const;
+
+	inline uint32_t WorkerCount() const
+	{
+		return static_cast<uint32_t>( workers.size() );
+	}
+
+	// Consistent only while the system is idle
+	std::vector<jobWorkerStats_t>	Stats() const;
+};
+}
@@ -0,0 +1,266 @@
+#include "linearAllocator.h"
+
+#include <string.h>
+#include <vector>
+
+#include "hashMap.h"
+#include "smallArray.h"
+
+namespace SysCore
+{
+LinearAllocator::LinearAllocator()
+	: buffer( nullptr ), capacity( 0 ), offset( 0 ), peak( 0 ), ownsBuffer( false ), tag( memTag_t::ARENA )
+{}
+
+
+LinearAllocator::LinearAllocator( const uint64_t capacity, const memTag_t _tag )
+	: buffer( nullptr ), capacity( 0 ), offset( 0 ), peak( 0 ), ownsBuffer( false ), tag( _tag )
+{
+	Init( capacity, _tag );
+}
+
+
+LinearAllocator::LinearAllocator( void* externalBuffer, const uint64_t capacity )
+	: buffer( nullptr ), capacity( 0 ), offset( 0 ), peak( 0 ), ownsBuffer( false ), tag( memTag_t::ARENA )
+{
+	Init( externalBuffer, capacity );
+}
+
+
+LinearAllocator::~LinearAllocator()
+{
+	Shutdown();
+}
+
+
+void LinearAllocator::Init( const uint64_t _capacity, const memTag_t _tag )
+{
+	Shutdown();
+	buffer = static_cast<uint8_t*>( ::operator new( _capacity, std::align_val_t( CACHE_LINE_SIZE ) ) );
+	capacity = _capacity;
+	ownsBuffer = true;
+	tag = _tag;
+	MEM_TRACK_ALLOC( tag, capacity );
+	Poison( 0, capacity );
+}
+
+
+void LinearAllocator::Init( void* externalBuffer, const uint64_t _capacity )
+{
+	Shutdown();
+	buffer = static_cast<uint8_t*>( externalBuffer );
+	capacity = ( buffer != nullptr ) ? _capacity : 0;
+	ownsBuffer = false;
+	Poison( 0, capacity );
+}
+
+
+void LinearAllocator::Shutdown()
+{
+	if ( ownsBuffer )
+	{
+		MEM_TRACK_FREE( tag, capacity );
+		::operator delete( buffer, std::align_val_t( CACHE_LINE_SIZE ) );
+	}
+	buffer = nullptr;
+	capacity = 0;
+	offset = 0;
+	peak = 0;
+	ownsBuffer = false;
+}
+
+
+void* LinearAllocator::Allocate( const uint64_t size, const uint32_t alignment )
+{
+	assert( ( alignment > 0 ) && ( ( alignment & ( alignment - 1 ) ) == 0 ) );
+
+	// Align the address rather than the offset so external buffers work too
+	const uintptr_t base = reinterpret_cast<uintptr_t>( buffer );
+	const uintptr_t aligned = ( base + offset + alignment - 1 ) & ~static_cast<uintptr_t>( alignment - 1 );
+	const uint64_t first = static_cast<uint64_t>( aligned - base );
+
+	if ( ( first > capacity ) || ( size > ( capacity - first ) ) ) {
+		return nullptr;
+	}
+
+	offset = first + size;
+	peak = ( offset > peak ) ? offset : peak;
+	return buffer + first;
+}
+
+
+void LinearAllocator::Free( void* ptr, const uint64_t size )
+{
+	if ( ptr == nullptr ) {
+		return;
+	}
+	assert( Owns( ptr ) );
+
+	const uint64_t first = static_cast<uint64_t>( static_cast<uint8_t*>( ptr ) - buffer );
+	if ( ( first + size ) == offset )
+	{
+		Poison( first, offset );
+		offset = first;
+	}
+}
+
+
+LinearAllocator::marker_t LinearAllocator::GetMarker() const
+{
+	return offset;
+}
+
+
+void LinearAllocator::Rollback( const marker_t marker )
+{
+	if ( marker > offset )
+	{
+		assert( 0 ); // Marker is from a region that was already released
+		return;
+	}
+	Poison( marker, offset );
+	offset = marker;
+}
+
+
+void LinearAllocator::Reset()
+{
+	Rollback( 0 );
+}
+
+
+void LinearAllocator::Poison( const uint64_t first, const uint64_t last )
+{
+#ifdef LINEAR_ALLOCATOR_POISON
+	if ( last > first ) {
+		memset( buffer + first, PoisonByte, static_cast<size_t>( last - first ) );
+	}
+#else
+	( void )first;
+	( void )last;
+#endif
+}
+
+
+void TestLinearAllocator()
+{
+    // --- Alignment and exhaustion ---
+    {
+        LinearAllocator arena( 256 );
+        assert( arena.Capacity() == 256 );
+
+        void* a = arena.Allocate( 3, 1 );
+        void* b = arena.Allocate( 8, 64 );
+        assert( a != nullptr && b != nullptr );
+        assert( ( reinterpret_cast<uintptr_t>( b ) & 63 ) == 0 );
+        assert( arena.Owns( a ) && arena.Owns( b ) );
+        assert( arena.Peak() == arena.Used() );
+
+        assert( arena.Allocate( 1024 ) == nullptr );
+        assert( arena.Allocate( arena.Remaining(), 1 ) != nullptr );
+        assert( arena.Remaining() == 0 );
+        assert( arena.Allocate( 1, 1 ) == nullptr );
+
+        arena.Reset();
+        assert( arena.Used() == 0 );
+        assert( arena.Peak() == 256 );
+    }
+
+    // --- Markers and scopes ---
+    {
+        LinearAllocator arena( 1024 );
+        uint32_t* persistent = arena.New<uint32_t>( 7u );
+        const LinearAllocator::marker_t marker = arena.GetMarker();
+        {
+            LinearAllocatorScope scope( arena );
+            uint64_t* scratch = arena.NewArray<uint64_t>( 16 );
+            assert( scratch != nullptr );
+            assert( arena.Used() > marker );
+        }
+        assert( arena.GetMarker() == marker );
+        assert( *persistent == 7 );
+
+        // Only the top allocation is reclaimed by Free
+        void* a = arena.Allocate( 32 );
+        void* b = arena.Allocate( 32 );
+        const uint64_t used = arena.Used();
+        arena.Free( a, 32 );
+        assert( arena.Used() == used );
+        arena.Free( b, 32 );
+        assert( arena.Used() < used );
+    }
+
+#ifdef LINEAR_ALLOCATOR_POISON
+    // --- Released memory is poisoned ---
+    {
+        LinearAllocator arena( 64 );
+        uint8_t* bytes = static_cast<uint8_t*>( arena.Allocate( 16 ) );
+        memset( bytes, 0, 16 );
+        arena.Reset();
+        for ( uint32_t i = 0; i < 16; ++i ) {
+            assert( bytes[ i ] == LinearAllocator::PoisonByte );
+        }
+    }
+#endif
+
+    // --- External buffer ---
+    {
+        alignas( 16 ) uint8_t storage[ 128 ];
+        LinearAllocator arena( storage, sizeof( storage ) );
+        void* mem = arena.Allocate( 64 );
+        assert( mem == storage );
+        assert( !arena.Owns( &arena ) );
+    }
+
+    // --- Frame ring keeps the previous frame alive ---
+    {
+        FrameAllocator<2> frames( 256 );
+        uint32_t* first = static_cast<uint32_t*>( frames.Allocate( sizeof( uint32_t ) ) );
+        *first = 42;
+        frames.BeginFrame();
+        assert( frames.Current().Used() == 0 );
+        frames.Allocate( 64 );
+        assert( *first == 42 );
+        frames.BeginFrame();
+        assert( frames.FrameIndex() == 0 );
+        assert( frames.Current().Used() == 0 );
+    }
+
+    // --- Containers on the arena ---
+    {
+        LinearAllocator arena( 64 * 1024 );
+        {
+            std::vector<uint32_t, ArenaAllocator<uint32_t>> values{ ArenaAllocator<uint32_t>( arena ) };
+            for ( uint32_t i = 0; i < 1000; ++i ) {
+                values.push_back( i );
+            }
+            assert( values[ 999 ] == 999 );
+            assert( arena.Owns( values.data() ) );
+        }
+
+        SmallArray<uint32_t, 4, ArenaAllocator<uint32_t>> small{ ArenaAllocator<uint32_t>( arena ) };
+        for ( uint32_t i = 0; i < 64; ++i ) {
+            small.Append( i );
+        }
+        assert( !small.IsInline() );
+        assert( arena.Owns( small.Ptr() ) );
+
+        using MapAllocator = ArenaAllocator<std::pair<uint32_t, uint32_t>>;
+        HashMap<uint32_t, uint32_t, HashMapHasher<uint32_t>, MapAllocator> map{ MapAllocator( arena ) };
+        for ( uint32_t i = 0; i < 200; ++i ) {
+            map.Insert( i, i * 2 );
+        }
+        assert( map.Count() == 200 );
+        assert( *map.Find( 123 ) == 246 );
+
+        bool threw = false;
+        try {
+            std::vector<uint8_t, ArenaAllocator<uint8_t>> huge{ ArenaAllocator<uint8_t>( arena ) };
+            huge.resize( 1024 * 1024 );
+        } catch ( const std::bad_alloc& ) {
+            threw = true;
+        }
+        assert( threw );
+    }
+}
+}
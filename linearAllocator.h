@@ -0,0 +1,246 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "common.h"
+#include "memTracker.h"
+
+#if defined( _DEBUG ) && !defined( LINEAR_ALLOCATOR_POISON )
+#define LINEAR_ALLOCATOR_POISON
+#endif
+
+namespace SysCore
+{
+void TestLinearAllocator();
+
+// Bump-pointer arena. Allocations are only released in bulk, either by rolling
+// back to a marker or by Reset(). With LINEAR_ALLOCATOR_POISON released bytes are
+// filled with PoisonByte so reads of stale memory stand out
+class LinearAllocator
+{
+private:
+	uint8_t*	buffer;
+	uint64_t	capacity;
+	uint64_t	offset;
+	uint64_t	peak;
+	bool		ownsBuffer;
+	memTag_t	tag;
+
+	void Poison( const uint64_t first, const uint64_t last );
+
+public:
+	using marker_t = uint64_t;
+
+	static const uint8_t PoisonByte = 0xDD;
+	static const uint32_t DefaultAlignment = 16;
+
+	LinearAllocator();
+	LinearAllocator( const uint64_t capacity, const memTag_t tag = memTag_t::ARENA );
+	LinearAllocator( void* externalBuffer, const uint64_t capacity );
+	~LinearAllocator();
+
+	LinearAllocator( const LinearAllocator& ) = delete;
+	LinearAllocator& operator=( const LinearAllocator& ) = delete;
+
+	// Takes ownership of a new heap block, reported under tag. Any previous contents are released
+	void Init( const uint64_t capacity, const memTag_t tag = memTag_t::ARENA );
+	// Uses caller-owned memory, which must outlive the allocator
+	void Init( void* externalBuffer, const uint64_t capacity );
+	void Shutdown();
+
+	// Returns nullptr when the arena is exhausted. Alignment must be a power of two
+	void* Allocate( const uint64_t size, const uint32_t alignment = DefaultAlignment );
+
+	// Only the most recent allocation can actually be reclaimed, anything else
+	// stays reserved until a rollback or reset
+	void Free( void* ptr, const uint64_t size );
+
+	marker_t GetMarker() const;
+	void Rollback( const marker_t marker );
+	void Reset();
+
+	template<class T, typename... Args>
+	inline T* New( Args&&... args )
+	{
+		void* mem = Allocate( sizeof( T ), alignof( T ) );
+		return ( mem != nullptr ) ? new ( mem ) T( std::forward<Args>( args )... ) : nullptr;
+	}
+
+	// Default constructs count elements. Destructors are never run by the arena
+	template<class T>
+	inline T* NewArray( const uint32_t count )
+	{
+		T* mem = static_cast<T*>( Allocate( static_cast<uint64_t>( count ) * sizeof( T ), alignof( T ) ) );
+		if ( mem != nullptr )
+		{
+			for ( uint32_t i = 0; i < count; ++i ) {
+				new ( mem + i ) T;
+			}
+		}
+		return mem;
+	}
+
+	inline bool Owns( const void* ptr ) const
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>( ptr );
+		return ( bytes >= buffer ) && ( bytes < ( buffer + capacity ) );
+	}
+
+	inline uint64_t Used() const
+	{
+		return offset;
+	}
+
+	inline uint64_t Remaining() const
+	{
+		return ( capacity - offset );
+	}
+
+	inline uint64_t Capacity() const
+	{
+		return capacity;
+	}
+
+	// High-water mark since Init() or the last ResetPeak()
+	inline uint64_t Peak() const
+	{
+		return peak;
+	}
+
+	inline void ResetPeak()
+	{
+		peak = offset;
+	}
+};
+
+
+// Rolls the arena back to where it was when the scope was entered
+class LinearAllocatorScope
+{
+private:
+	LinearAllocator&			arena;
+	LinearAllocator::marker_t	marker;
+
+public:
+	LinearAllocatorScope( LinearAllocator& _arena ) : arena( _arena ), marker( _arena.GetMarker() )
+	{}
+
+	~LinearAllocatorScope()
+	{
+		arena.Rollback( marker );
+	}
+
+	LinearAllocatorScope( const LinearAllocatorScope& ) = delete;
+	LinearAllocatorScope& operator=( const LinearAllocatorScope& ) = delete;
+};
+
+
+// Ring of per-frame arenas. BeginFrame() advances to the next arena and resets it,
+// so data allocated in a frame stays valid for FrameCount - 1 frames after it
+template<uint32_t FrameCount = 2>
+class FrameAllocator
+{
+private:
+	static_assert( FrameCount > 0, "FrameAllocator needs at least one frame" );
+
+	LinearAllocator	frames[ FrameCount ];
+	uint32_t		frameIx;
+
+public:
+	FrameAllocator() : frameIx( 0 )
+	{}
+
+	FrameAllocator( const uint64_t capacityPerFrame, const memTag_t tag = memTag_t::ARENA ) : frameIx( 0 )
+	{
+		Init( capacityPerFrame, tag );
+	}
+
+	inline void Init( const uint64_t capacityPerFrame, const memTag_t tag = memTag_t::ARENA )
+	{
+		for ( uint32_t i = 0; i < FrameCount; ++i ) {
+			frames[ i ].Init( capacityPerFrame, tag );
+		}
+		frameIx = 0;
+	}
+
+	inline void BeginFrame()
+	{
+		frameIx = ( frameIx + 1 ) % FrameCount;
+		frames[ frameIx ].Reset();
+	}
+
+	inline LinearAllocator& Current()
+	{
+		return frames[ frameIx ];
+	}
+
+	inline uint32_t FrameIndex() const
+	{
+		return frameIx;
+	}
+
+	inline void* Allocate( const uint64_t size, const uint32_t alignment = LinearAllocator::DefaultAlignment )
+	{
+		return frames[ frameIx ].Allocate( size, alignment );
+	}
+};
+
+
+// std-compatible allocator over a LinearAllocator, usable with std::vector,
+// SmallArray and HashMap. Exhausting the arena throws std::bad_alloc like the
+// global allocator would; deallocation only reclaims the topmost block
+template<class T>
+class ArenaAllocator
+{
+private:
+	template<class U> friend class ArenaAllocator;
+
+	LinearAllocator*	arena;
+
+public:
+	using value_type = T;
+
+	ArenaAllocator( LinearAllocator& _arena ) noexcept : arena( &_arena )
+	{}
+
+	template<class U>
+	ArenaAllocator( const ArenaAllocator<U>& rhs ) noexcept : arena( rhs.arena )
+	{}
+
+	inline T* allocate( const size_t n )
+	{
+		// Containers may do vector loads over whole blocks, keep at least DefaultAlignment
+		const uint32_t alignment = ( alignof( T ) > LinearAllocator::DefaultAlignment ) ? alignof( T ) : LinearAllocator::DefaultAlignment;
+		void* mem = arena->Allocate( static_cast<uint64_t>( n ) * sizeof( T ), alignment );
+		if ( mem == nullptr ) {
+			throw std::bad_alloc();
+		}
+		return static_cast<T*>( mem );
+	}
+
+	inline void deallocate( T* ptr, const size_t n ) noexcept
+	{
+		arena->Free( ptr, static_cast<uint64_t>( n ) * sizeof( T ) );
+	}
+
+	inline LinearAllocator* Arena() const
+	{
+		return arena;
+	}
+
+	template<class U>
+	inline bool operator==( const ArenaAllocator<U>& rhs ) const
+	{
+		return ( arena == rhs.arena );
+	}
+
+	template<class U>
+	inline bool operator!=( const ArenaAllocator<U>& rhs ) const
+	{
+		return ( arena != rhs.arena );
+	}
+};
+}
@@ -0,0 +1,288 @@
+#include "lockProfiler.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string.h>
+#include <thread>
+
+#include "common.h"
+#include "rwLock.h"
+#include "spinlock.h"
+#include "threadRegistry.h"
+
+static const uint32_t MaxProfiledLocks = 256;
+
+struct lockCounters_t
+{
+	std::atomic<uint64_t>	acquisitions;
+	std::atomic<uint64_t>	contended;
+	std::atomic<uint64_t>	totalWaitNs;
+	std::atomic<uint64_t>	maxWaitNs;
+	std::atomic<uint64_t>	maxHoldNs;
+};
+
+// Only the owning thread writes its counters, so recording never takes a shared
+// line. They're atomics so a report can read them from another thread
+struct lockThreadRecord_t
+{
+	lockCounters_t			counters[ MaxProfiledLocks ];
+};
+
+struct lockRetired_t
+{
+	uint64_t	acquisitions = 0;
+	uint64_t	contended = 0;
+	uint64_t	totalWaitNs = 0;
+	uint64_t	maxWaitNs = 0;
+	uint64_t	maxHoldNs = 0;
+};
+
+struct lockProfilerState_t
+{
+	std::mutex							lock;	// Guards names and retired
+	std::vector<std::string>			names{ "Unnamed" };
+	lockRetired_t						retired[ MaxProfiledLocks ];
+};
+
+
+static lockProfilerState_t& ProfilerState()
+{
+	static lockProfilerState_t state;
+	return state;
+}
+
+
+static inline void StoreMax( std::atomic<uint64_t>& counter, const uint64_t value )
+{
+	if ( value > counter.load( std::memory_order_relaxed ) ) {
+		counter.store( value, std::memory_order_relaxed );
+	}
+}
+
+
+static inline void Increment( std::atomic<uint64_t>& counter, const uint64_t value )
+{
+	counter.store( counter.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+}
+
+
+static void ClearCounters( lockCounters_t& counters )
+{
+	counters.acquisitions.store( 0, std::memory_order_relaxed );
+	counters.contended.store( 0, std::memory_order_relaxed );
+	counters.totalWaitNs.store( 0, std::memory_order_relaxed );
+	counters.maxWaitNs.store( 0, std::memory_order_relaxed );
+	counters.maxHoldNs.store( 0, std::memory_order_relaxed );
+}
+
+
+// Folds an exiting thread's counters into the retired totals
+static void RetireRecord( lockThreadRecord_t& record )
+{
+	lockProfilerState_t& state = ProfilerState();
+	std::lock_guard<std::mutex> guard( state.lock );
+	for ( uint32_t i = 0; i < MaxProfiledLocks; ++i )
+	{
+		lockCounters_t& counters = record.counters[ i ];
+		lockRetired_t& retired = state.retired[ i ];
+		retired.acquisitions += counters.acquisitions.load( std::memory_order_relaxed );
+		retired.contended += counters.contended.load( std::memory_order_relaxed );
+		retired.totalWaitNs += counters.totalWaitNs.load( std::memory_order_relaxed );
+		retired.maxWaitNs = std::max( retired.maxWaitNs, counters.maxWaitNs.load( std::memory_order_relaxed ) );
+		retired.maxHoldNs = std::max( retired.maxHoldNs, counters.maxHoldNs.load( std::memory_order_relaxed ) );
+		ClearCounters( counters );
+	}
+}
+
+
+using lockRegistry_t = SysCore::ThreadRegistry<lockThreadRecord_t, RetireRecord>;
+
+
+static inline lockCounters_t& ThreadCounters( const uint32_t id )
+{
+	assert( id < MaxProfiledLocks );
+	return lockRegistry_t::Local().counters[ id ];
+}
+
+
+uint32_t LockProfileRegister( const char* name )
+{
+	if ( ( name == nullptr ) || ( name[ 0 ] == '\0' ) ) {
+		return 0;
+	}
+
+	lockProfilerState_t& state = ProfilerState();
+	std::lock_guard<std::mutex> guard( state.lock );
+
+	for ( uint32_t i = 1; i < static_cast<uint32_t>( state.names.size() ); ++i )
+	{
+		if ( state.names[ i ] == name ) {
+			return i;
+		}
+	}
+
+	if ( state.names.size() >= MaxProfiledLocks ) {
+		return 0;
+	}
+	state.names.push_back( name );
+	return static_cast<uint32_t>( state.names.size() - 1 );
+}
+
+
+void LockProfileAcquired( const uint32_t id, const bool contended, const uint64_t waitNs )
+{
+	lockCounters_t& counters = ThreadCounters( id );
+	Increment( counters.acquisitions, 1 );
+	if ( contended )
+	{
+		Increment( counters.contended, 1 );
+		Increment( counters.totalWaitNs, waitNs );
+		StoreMax( counters.maxWaitNs, waitNs );
+	}
+}
+
+
+void LockProfileReleased( const uint32_t id, const uint64_t holdNs )
+{
+	StoreMax( ThreadCounters( id ).maxHoldNs, holdNs );
+}
+
+
+std::vector<lockProfileStats_t> LockProfileSnapshot()
+{
+	lockProfilerState_t& state = ProfilerState();
+	std::vector<lockProfileStats_t> stats;
+
+	{
+		std::lock_guard<std::mutex> guard( state.lock );
+		stats.resize( state.names.size() );
+		for ( uint32_t i = 0; i < static_cast<uint32_t>( stats.size() ); ++i )
+		{
+			const lockRetired_t& retired = state.retired[ i ];
+			stats[ i ] = { state.names[ i ], retired.acquisitions, retired.contended, retired.totalWaitNs, retired.maxWaitNs, retired.maxHoldNs };
+		}
+	}
+
+	lockRegistry_t::ForEach( [&stats]( const lockThreadRecord_t& record ) {
+		for ( uint32_t i = 0; i < static_cast<uint32_t>( stats.size() ); ++i )
+		{
+			const lockCounters_t& counters = record.counters[ i ];
+			lockProfileStats_t& entry = stats[ i ];
+			entry.acquisitions += counters.acquisitions.load( std::memory_order_relaxed );
+			entry.contended += counters.contended.load( std::memory_order_relaxed );
+			entry.totalWaitNs += counters.totalWaitNs.load( std::memory_order_relaxed );
+			entry.maxWaitNs = std::max( entry.maxWaitNs, counters.maxWaitNs.load( std::memory_order_relaxed ) );
+			entry.maxHoldNs = std::max( entry.maxHoldNs, counters.maxHoldNs.load( std::memory_order_relaxed ) );
+		}
+	} );
+
+	stats.erase( std::remove_if( stats.begin(), stats.end(), []( const lockProfileStats_t& entry ) {
+		return ( entry.acquisitions == 0 );
+	} ), stats.end() );
+
+	std::sort( stats.begin(), stats.end(), []( const lockProfileStats_t& a, const lockProfileStats_t& b ) {
+		return ( a.totalWaitNs != b.totalWaitNs ) ? ( a.totalWaitNs > b.totalWaitNs ) : ( a.contended > b.contended );
+	} );
+	return stats;
+}
+
+
+void LockProfileReport()
+{
+	const std::vector<lockProfileStats_t> stats = LockProfileSnapshot();
+
+	std::cout << std::left << std::setw( 24 ) << "Lock" << std::right << std::setw( 14 ) << "Acquires" << std::setw( 12 ) << "Contended" << std::setw( 10 ) << "Rate"
+		<< std::setw( 14 ) << "Wait ms" << std::setw( 14 ) << "Avg wait us" << std::setw( 14 ) << "Max wait us" << std::setw( 14 ) << "Max hold us" << std::endl;
+
+	for ( const lockProfileStats_t& entry : stats )
+	{
+		const double contendedPercent = ( 100.0 * entry.contended ) / static_cast<double>( entry.acquisitions );
+		const double averageWaitUs = ( entry.contended > 0 ) ? ( entry.totalWaitNs / 1000.0 ) / entry.contended : 0.0;
+
+		std::cout << std::left << std::setw( 24 ) << entry.name << std::right << std::fixed << std::setprecision( 1 )
+			<< std::setw( 14 ) << entry.acquisitions << std::setw( 12 ) << entry.contended << std::setw( 9 ) << std::setprecision( 2 ) << contendedPercent << "%" << std::setprecision( 1 )
+			<< std::setw( 14 ) << ( entry.totalWaitNs / 1.0e6 ) << std::setw( 14 ) << averageWaitUs
+			<< std::setw( 14 ) << ( entry.maxWaitNs / 1000.0 ) << std::setw( 14 ) << ( entry.maxHoldNs / 1000.0 ) << std::endl;
+	}
+}
+
+
+void LockProfileReset()
+{
+	lockProfilerState_t& state = ProfilerState();
+	std::lock_guard<std::mutex> guard( state.lock );
+	for ( lockRetired_t& retired : state.retired ) {
+		retired = lockRetired_t();
+	}
+	lockRegistry_t::ForEach( []( lockThreadRecord_t& record ) {
+		for ( lockCounters_t& counters : record.counters ) {
+			ClearCounters( counters );
+		}
+	} );
+}
+
+
+void TestLockProfiler()
+{
+    LockProfileReset();
+
+    // --- Recording API, independent of the define ---
+    {
+        const uint32_t id = LockProfileRegister( "TestProfiledLock" );
+        assert( id != 0 );
+        assert( LockProfileRegister( "TestProfiledLock" ) == id );
+        assert( LockProfileRegister( nullptr ) == 0 );
+
+        LockProfileAcquired( id, false, 0 );
+        LockProfileAcquired( id, true, 5000 );
+        LockProfileReleased( id, 700 );
+
+        std::thread other( [id]() { LockProfileAcquired( id, true, 9000 ); } );
+        other.join();
+
+        const std::vector<lockProfileStats_t> stats = LockProfileSnapshot();
+        const auto entry = std::find_if( stats.begin(), stats.end(), []( const lockProfileStats_t& s ) { return s.name == "TestProfiledLock"; } );
+        assert( entry != stats.end() );
+        assert( entry->acquisitions == 3 );
+        assert( entry->contended == 2 );
+        assert( entry->totalWaitNs == 14000 );
+        assert( entry->maxWaitNs == 9000 );
+        assert( entry->maxHoldNs == 700 );
+    }
+
+#ifdef SYSCORE_LOCK_PROFILING
+    // --- Named locks report through the profiler ---
+    {
+        SpinLock lock( "TestSpinLock" );
+        RWLock rwLock( "TestRWLock" );
+        std::vector<std::thread> threads;
+        for ( uint32_t t = 0; t < 4; ++t )
+        {
+            threads.emplace_back( [&]() {
+                for ( uint32_t i = 0; i < 1000; ++i )
+                {
+                    SpinLockGuard guard( lock );
+                    RWLockReadGuard readGuard( rwLock );
+                }
+            } );
+        }
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+
+        const std::vector<lockProfileStats_t> stats = LockProfileSnapshot();
+        const auto spinEntry = std::find_if( stats.begin(), stats.end(), []( const lockProfileStats_t& s ) { return s.name == "TestSpinLock"; } );
+        const auto rwEntry = std::find_if( stats.begin(), stats.end(), []( const lockProfileStats_t& s ) { return s.name == "TestRWLock"; } );
+        assert( ( spinEntry != stats.end() ) && ( spinEntry->acquisitions == 4000 ) );
+        assert( ( rwEntry != stats.end() ) && ( rwEntry->acquisitions == 4000 ) );
+        assert( spinEntry->maxHoldNs > 0 );
+    }
+#endif
+
+    LockProfileReset();
+    assert( LockProfileSnapshot().empty() );
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+
+// Lock contention profiling is opt-in. With SYSCORE_LOCK_PROFILING defined
+// SpinLock and RWLock record every acquisition against their name; otherwise
+// names are ignored and the locks carry no extra state. The report API always
+// links and is simply empty when profiling is off.
+
+void TestLockProfiler();
+
+struct lockProfileStats_t
+{
+	std::string	name;
+	uint64_t	acquisitions;
+	uint64_t	contended;		// Acquisitions that had to wait
+	uint64_t	totalWaitNs;
+	uint64_t	maxWaitNs;
+	uint64_t	maxHoldNs;		// Exclusive holds only
+};
+
+// Locks with the same name share one entry. Returns the id locks pass to the
+// record functions, unnamed locks and names past the table size share id 0
+uint32_t		LockProfileRegister( const char* name );
+
+inline uint64_t LockProfileNow()
+{
+	return SysCore::MonotonicNowNs();
+}
+
+void			LockProfileAcquired( const uint32_t id, const bool contended, const uint64_t waitNs );
+void			LockProfileReleased( const uint32_t id, const uint64_t holdNs );
+
+// Merges every thread's counters, sorted by total wait time, busiest first.
+// Exact only while no other thread is taking profiled locks
+std::vector<lockProfileStats_t>	LockProfileSnapshot();
+void							LockProfileReport();
+void							LockProfileReset();
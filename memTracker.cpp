@@ -0,0 +1,303 @@
+#include "memTracker.h"
+
+#include <assert.h>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+#include "threadRegistry.h"
+
+namespace SysCore
+{
+static const uint32_t TagCount = static_cast<uint32_t>( memTag_t::COUNT );
+
+// Net bytes a thread may accumulate on a tag before folding them into the totals
+static const int64_t FlushThreshold = 64 * 1024;
+
+static const char* TagNames[ TagCount ] =
+{
+	"Untagged",
+	"Serializer",
+	"BitArray",
+	"Container",
+	"Arena",
+	"Pool",
+	"Asset",
+	"Render",
+	"Audio",
+	"Emulator",
+};
+
+// Counters are only written by the owning thread; atomics so queries can read them
+struct memThreadRecord_t
+{
+	std::atomic<int64_t>	pendingBytes[ TagCount ];
+	std::atomic<uint64_t>	allocCount[ TagCount ];
+	std::atomic<uint64_t>	freeCount[ TagCount ];
+};
+
+struct memTrackerState_t
+{
+	std::atomic<int64_t>			flushedBytes[ TagCount ];
+	std::atomic<int64_t>			peakBytes[ TagCount ];
+	std::atomic<uint64_t>			budgetBytes[ TagCount ];
+
+	// Counts of exited threads, only touched with retiredLock held
+	std::mutex						retiredLock;
+	uint64_t						retiredAllocs[ TagCount ] = {};
+	uint64_t						retiredFrees[ TagCount ] = {};
+
+	memTrackerState_t()
+	{
+		for ( uint32_t i = 0; i < TagCount; ++i )
+		{
+			flushedBytes[ i ].store( 0, std::memory_order_relaxed );
+			peakBytes[ i ].store( 0, std::memory_order_relaxed );
+			budgetBytes[ i ].store( 0, std::memory_order_relaxed );
+		}
+	}
+};
+
+
+static memTrackerState_t& TrackerState()
+{
+	static memTrackerState_t state;
+	return state;
+}
+
+
+static inline void RaisePeak( const uint32_t tagIx, const int64_t bytes )
+{
+	std::atomic<int64_t>& peak = TrackerState().peakBytes[ tagIx ];
+	int64_t current = peak.load( std::memory_order_relaxed );
+	while ( ( bytes > current ) && !peak.compare_exchange_weak( current, bytes, std::memory_order_relaxed ) ) {
+	}
+}
+
+
+static inline void FlushPending( memThreadRecord_t& record, const uint32_t tagIx )
+{
+	const int64_t pending = record.pendingBytes[ tagIx ].load( std::memory_order_relaxed );
+	record.pendingBytes[ tagIx ].store( 0, std::memory_order_relaxed );
+	const int64_t total = TrackerState().flushedBytes[ tagIx ].fetch_add( pending, std::memory_order_relaxed ) + pending;
+	RaisePeak( tagIx, total );
+}
+
+
+// Folds an exiting thread's counts into the totals
+static void RetireRecord( memThreadRecord_t& record )
+{
+	memTrackerState_t& state = TrackerState();
+	std::lock_guard<std::mutex> guard( state.retiredLock );
+	for ( uint32_t i = 0; i < TagCount; ++i )
+	{
+		FlushPending( record, i );
+		state.retiredAllocs[ i ] += record.allocCount[ i ].load( std::memory_order_relaxed );
+		state.retiredFrees[ i ] += record.freeCount[ i ].load( std::memory_order_relaxed );
+		record.allocCount[ i ].store( 0, std::memory_order_relaxed );
+		record.freeCount[ i ].store( 0, std::memory_order_relaxed );
+	}
+}
+
+
+using memRegistry_t = ThreadRegistry<memThreadRecord_t, RetireRecord>;
+
+
+void MemTrackAlloc( const memTag_t tag, const uint64_t bytes )
+{
+	const uint32_t tagIx = static_cast<uint32_t>( tag );
+	assert( tagIx < TagCount );
+
+	memThreadRecord_t& record = memRegistry_t::Local();
+	record.allocCount[ tagIx ].store( record.allocCount[ tagIx ].load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+
+	const int64_t pending = record.pendingBytes[ tagIx ].load( std::memory_order_relaxed ) + static_cast<int64_t>( bytes );
+	record.pendingBytes[ tagIx ].store( pending, std::memory_order_relaxed );
+	if ( pending >= FlushThreshold ) {
+		FlushPending( record, tagIx );
+	}
+}
+
+
+void MemTrackFree( const memTag_t tag, const uint64_t bytes )
+{
+	const uint32_t tagIx = static_cast<uint32_t>( tag );
+	assert( tagIx < TagCount );
+
+	memThreadRecord_t& record = memRegistry_t::Local();
+	record.freeCount[ tagIx ].store( record.freeCount[ tagIx ].load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+
+	// Frees can't raise the peak, but large negative balances are flushed too so
+	// one thread freeing what another allocated doesn't hide a later peak
+	const int64_t pending = record.pendingBytes[ tagIx ].load( std::memory_order_relaxed ) - static_cast<int64_t>( bytes );
+	record.pendingBytes[ tagIx ].store( pending, std::memory_order_relaxed );
+	if ( pending <= -FlushThreshold ) {
+		FlushPending( record, tagIx );
+	}
+}
+
+
+void MemTrackSetBudget( const memTag_t tag, const uint64_t bytes )
+{
+	TrackerState().budgetBytes[ static_cast<uint32_t>( tag ) ].store( bytes, std::memory_order_relaxed );
+}
+
+
+const char* MemTagName( const memTag_t tag )
+{
+	const uint32_t tagIx = static_cast<uint32_t>( tag );
+	return ( tagIx < TagCount ) ? TagNames[ tagIx ] : "Invalid";
+}
+
+
+memSnapshot_t MemTrackSnapshot()
+{
+	memTrackerState_t& state = TrackerState();
+	memSnapshot_t snapshot = {};
+
+	{
+		std::lock_guard<std::mutex> guard( state.retiredLock );
+		for ( uint32_t i = 0; i < TagCount; ++i )
+		{
+			snapshot.tags[ i ].allocCount = state.retiredAllocs[ i ];
+			snapshot.tags[ i ].freeCount = state.retiredFrees[ i ];
+		}
+	}
+
+	for ( uint32_t i = 0; i < TagCount; ++i ) {
+		snapshot.tags[ i ].currentBytes = state.flushedBytes[ i ].load( std::memory_order_relaxed );
+	}
+
+	memRegistry_t::ForEach( [&snapshot]( const memThreadRecord_t& record ) {
+		for ( uint32_t i = 0; i < TagCount; ++i )
+		{
+			snapshot.tags[ i ].currentBytes += record.pendingBytes[ i ].load( std::memory_order_relaxed );
+			snapshot.tags[ i ].allocCount += record.allocCount[ i ].load( std::memory_order_relaxed );
+			snapshot.tags[ i ].freeCount += record.freeCount[ i ].load( std::memory_order_relaxed );
+		}
+	} );
+
+	for ( uint32_t i = 0; i < TagCount; ++i )
+	{
+		// The merged total may be above the last flushed peak
+		RaisePeak( i, snapshot.tags[ i ].currentBytes );
+		snapshot.tags[ i ].peakBytes = state.peakBytes[ i ].load( std::memory_order_relaxed );
+		snapshot.tags[ i ].budgetBytes = state.budgetBytes[ i ].load( std::memory_order_relaxed );
+	}
+	return snapshot;
+}
+
+
+memSnapshot_t MemTrackDiff( const memSnapshot_t& before, const memSnapshot_t& after )
+{
+	memSnapshot_t diff = after;
+	for ( uint32_t i = 0; i < TagCount; ++i )
+	{
+		diff.tags[ i ].currentBytes = after.tags[ i ].currentBytes - before.tags[ i ].currentBytes;
+		diff.tags[ i ].allocCount = after.tags[ i ].allocCount - before.tags[ i ].allocCount;
+		diff.tags[ i ].freeCount = after.tags[ i ].freeCount - before.tags[ i ].freeCount;
+	}
+	return diff;
+}
+
+
+bool MemTrackReport( const memSnapshot_t& snapshot )
+{
+	bool withinBudget = true;
+
+	std::cout << std::left << std::setw( 12 ) << "Tag" << std::right << std::setw( 14 ) << "Current KB" << std::setw( 14 ) << "Peak KB"
+		<< std::setw( 12 ) << "Allocs" << std::setw( 12 ) << "Frees" << std::setw( 14 ) << "Budget KB" << std::endl;
+
+	for ( uint32_t i = 0; i < TagCount; ++i )
+	{
+		const memTagStats_t& stats = snapshot.tags[ i ];
+		if ( ( stats.allocCount == 0 ) && ( stats.freeCount == 0 ) && ( stats.currentBytes == 0 ) ) {
+			continue;
+		}
+
+		const bool overBudget = ( stats.budgetBytes > 0 ) && ( stats.currentBytes > static_cast<int64_t>( stats.budgetBytes ) );
+		withinBudget &= !overBudget;
+
+		std::cout << std::left << std::setw( 12 ) << TagNames[ i ] << std::right << std::fixed << std::setprecision( 1 )
+			<< std::setw( 14 ) << BYTES_TO_KB( stats.currentBytes ) << std::setw( 14 ) << BYTES_TO_KB( stats.peakBytes )
+			<< std::setw( 12 ) << stats.allocCount << std::setw( 12 ) << stats.freeCount << std::setw( 14 );
+		if ( stats.budgetBytes > 0 ) {
+			std::cout << BYTES_TO_KB( stats.budgetBytes );
+		} else {
+			std::cout << "-";
+		}
+		std::cout << ( overBudget ? "  OVER BUDGET" : "" ) << std::endl;
+	}
+	return withinBudget;
+}
+
+
+void TestMemTracker()
+{
+    // --- Counts, peak and diff on one thread ---
+    {
+        const memSnapshot_t before = MemTrackSnapshot();
+
+        MemTrackAlloc( memTag_t::ASSET, 1000 );
+        MemTrackAlloc( memTag_t::ASSET, 200 * 1024 );
+        MemTrackFree( memTag_t::ASSET, 1000 );
+
+        const memSnapshot_t after = MemTrackSnapshot();
+        const memSnapshot_t diff = MemTrackDiff( before, after );
+        assert( diff[ memTag_t::ASSET ].currentBytes == 200 * 1024 );
+        assert( diff[ memTag_t::ASSET ].allocCount == 2 );
+        assert( diff[ memTag_t::ASSET ].freeCount == 1 );
+        assert( after[ memTag_t::ASSET ].peakBytes >= after[ memTag_t::ASSET ].currentBytes );
+        assert( diff[ memTag_t::AUDIO ].allocCount == 0 );
+
+        MemTrackFree( memTag_t::ASSET, 200 * 1024 );
+        const memSnapshot_t released = MemTrackDiff( before, MemTrackSnapshot() );
+        assert( released[ memTag_t::ASSET ].currentBytes == 0 );
+        assert( released[ memTag_t::ASSET ].peakBytes >= 200 * 1024 );
+    }
+
+    // --- Threads merge, including ones that have exited ---
+    {
+        const memSnapshot_t before = MemTrackSnapshot();
+
+        std::vector<std::thread> threads;
+        for ( uint32_t t = 0; t < 4; ++t )
+        {
+            threads.emplace_back( []() {
+                for ( uint32_t i = 0; i < 1000; ++i ) {
+                    MemTrackAlloc( memTag_t::RENDER, 100 );
+                }
+                for ( uint32_t i = 0; i < 500; ++i ) {
+                    MemTrackFree( memTag_t::RENDER, 100 );
+                }
+            } );
+        }
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+
+        const memSnapshot_t diff = MemTrackDiff( before, MemTrackSnapshot() );
+        assert( diff[ memTag_t::RENDER ].currentBytes == 4 * 500 * 100 );
+        assert( diff[ memTag_t::RENDER ].allocCount == 4000 );
+        assert( diff[ memTag_t::RENDER ].freeCount == 2000 );
+        MemTrackFree( memTag_t::RENDER, 4 * 500 * 100 );
+    }
+
+    // --- Budgets and the allocator ---
+    {
+        MemTrackSetBudget( memTag_t::EMULATOR, 1024 );
+        {
+            std::vector<uint8_t, TrackedAllocator<uint8_t, memTag_t::EMULATOR>> scratch( 4096 );
+            const memSnapshot_t snapshot = MemTrackSnapshot();
+            assert( snapshot[ memTag_t::EMULATOR ].currentBytes >= 4096 );
+            assert( snapshot[ memTag_t::EMULATOR ].budgetBytes == 1024 );
+        }
+        assert( MemTrackSnapshot()[ memTag_t::EMULATOR ].currentBytes == 0 );
+        MemTrackSetBudget( memTag_t::EMULATOR, 0 );
+        assert( std::string( MemTagName( memTag_t::SERIALIZER ) ) == "Serializer" );
+    }
+}
+}
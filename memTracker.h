@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+// Tracking is opt-in. Without SYSCORE_MEMORY_TRACKING the hooks compile away and
+// TaggedAllocator is plain std::allocator, the query API still links but reports zeros
+#ifdef SYSCORE_MEMORY_TRACKING
+#define MEM_TRACK_ALLOC( tag, bytes )	SysCore::MemTrackAlloc( tag, bytes )
+#define MEM_TRACK_FREE( tag, bytes )	SysCore::MemTrackFree( tag, bytes )
+#else
+#define MEM_TRACK_ALLOC( tag, bytes )
+#define MEM_TRACK_FREE( tag, bytes )
+#endif
+
+namespace SysCore
+{
+void TestMemTracker();
+
+enum class memTag_t : uint32_t
+{
+	UNTAGGED,
+	SERIALIZER,
+	BIT_ARRAY,
+	CONTAINER,
+	ARENA,
+	POOL,
+	ASSET,
+	RENDER,
+	AUDIO,
+	EMULATOR,
+	COUNT,
+};
+
+struct memTagStats_t
+{
+	int64_t		currentBytes;
+	int64_t		peakBytes;
+	uint64_t	allocCount;
+	uint64_t	freeCount;
+	uint64_t	budgetBytes;	// 0 when no budget is set
+};
+
+struct memSnapshot_t
+{
+	memTagStats_t	tags[ static_cast<uint32_t>( memTag_t::COUNT ) ];
+
+	inline const memTagStats_t& operator[]( const memTag_t tag ) const
+	{
+		return tags[ static_cast<uint32_t>( tag ) ];
+	}
+};
+
+// Counting goes to per-thread counters with no shared writes. Net byte changes are
+// folded into the shared totals once they pass a threshold, which is also when the
+// peak is updated, so peaks are exact to within that threshold per thread
+void			MemTrackAlloc( const memTag_t tag, const uint64_t bytes );
+void			MemTrackFree( const memTag_t tag, const uint64_t bytes );
+
+void			MemTrackSetBudget( const memTag_t tag, const uint64_t bytes );
+const char*		MemTagName( const memTag_t tag );
+
+// Merges every thread's counters. Only exact while other threads are not allocating
+memSnapshot_t	MemTrackSnapshot();
+
+// Changes from before to after: current bytes and counts are deltas,
+// peak and budget are taken from after
+memSnapshot_t	MemTrackDiff( const memSnapshot_t& before, const memSnapshot_t& after );
+
+// Prints non-empty tags, flagging any over budget. Returns false if one is
+bool			MemTrackReport( const memSnapshot_t& snapshot );
+
+
+// std-compatible allocator that reports to a tag
+template<class T, memTag_t Tag>
+class TrackedAllocator
+{
+public:
+	using value_type = T;
+
+	template<class U>
+	struct rebind
+	{
+		using other = TrackedAllocator<U, Tag>;
+	};
+
+	TrackedAllocator() noexcept = default;
+
+	template<class U>
+	TrackedAllocator( const TrackedAllocator<U, Tag>& ) noexcept
+	{}
+
+	inline T* allocate( const size_t n )
+	{
+		T* ptr = std::allocator<T>().allocate( n );
+		MemTrackAlloc( Tag, n * sizeof( T ) );
+		return ptr;
+	}
+
+	inline void deallocate( T* ptr, const size_t n ) noexcept
+	{
+		MemTrackFree( Tag, n * sizeof( T ) );
+		std::allocator<T>().deallocate( ptr, n );
+	}
+
+	template<class U>
+	inline bool operator==( const TrackedAllocator<U, Tag>& ) const
+	{
+		return true;
+	}
+
+	template<class U>
+	inline bool operator!=( const TrackedAllocator<U, Tag>& ) const
+	{
+		return false;
+	}
+};
+
+// Default allocator for SysCore containers
+#ifdef SYSCORE_MEMORY_TRACKING
+template<class T, memTag_t Tag>
+using TaggedAllocator = TrackedAllocator<T, Tag>;
+#else
+template<class T, memTag_t Tag>
+using TaggedAllocator = std::allocator<T>;
+#endif
+}
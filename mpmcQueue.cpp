@@ -0,0 +1,166 @@
+#include "mpmcQueue.h"
+
+#include <assert.h>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "timer.h"
+
+namespace SysCore
+{
+void TestMpmcQueue()
+{
+    // --- Single thread push/pop ---
+    {
+        MpmcQueue<uint32_t, 8> q;
+        uint32_t value = 0;
+        assert( !q.TryPop( value ) );
+
+        for ( uint32_t i = 0; i < 8; ++i ) {
+            assert( q.TryPush( i ) );
+        }
+        assert( !q.TryPush( 8u ) );
+        assert( q.Count() == 8 );
+
+        for ( uint32_t i = 0; i < 3; ++i )
+        {
+            assert( q.TryPop( value ) );
+            assert( value == i );
+        }
+
+        const uint32_t src[] = { 100, 101, 102, 103, 104 };
+        assert( q.TryPushN( src, COUNTARRAY( src ) ) == 3 );
+
+        uint32_t dst[ 16 ] = {};
+        assert( q.TryPopN( dst, 16 ) == 8 );
+        assert( dst[ 0 ] == 3 && dst[ 4 ] == 7 && dst[ 5 ] == 100 && dst[ 7 ] == 102 );
+        assert( q.TryPopN( dst, 16 ) == 0 );
+        assert( q.Count() == 0 );
+    }
+
+    // --- Stress: every pushed value is popped exactly once ---
+    {
+        static MpmcQueue<uint64_t, 256> q;
+
+        const uint32_t producerCount = 4;
+        const uint32_t consumerCount = 4;
+        const uint32_t perProducer = 100000;
+        const uint64_t total = static_cast<uint64_t>( producerCount ) * perProducer;
+
+        std::atomic<uint64_t> poppedTotal( 0 );
+        std::vector<std::vector<uint64_t>> received( consumerCount );
+        std::vector<std::thread> threads;
+
+        for ( uint32_t p = 0; p < producerCount; ++p )
+        {
+            threads.emplace_back( [&, p]() {
+                uint64_t block[ 8 ];
+                uint32_t next = 0;
+                while ( next < perProducer )
+                {
+                    // Alternate single and batched pushes
+                    const uint32_t blockCount = ( ( next & 1 ) == 0 ) ? 1 : std::min<uint32_t>( 8, perProducer - next );
+                    for ( uint32_t i = 0; i < blockCount; ++i ) {
+                        block[ i ] = ( static_cast<uint64_t>( p ) << 32 ) | ( next + i );
+                    }
+                    const uint32_t pushed = q.TryPushN( block, blockCount );
+                    if ( pushed == 0 ) {
+                        std::this_thread::yield();
+                    }
+                    next += pushed;
+                }
+            } );
+        }
+
+        for ( uint32_t c = 0; c < consumerCount; ++c )
+        {
+            threads.emplace_back( [&, c]() {
+                uint64_t block[ 8 ];
+                while ( poppedTotal.load( std::memory_order_relaxed ) < total )
+                {
+                    const uint32_t popped = ( ( c & 1 ) == 0 ) ? ( q.TryPop( block[ 0 ] ) ? 1 : 0 ) : q.TryPopN( block, 8 );
+                    if ( popped == 0 )
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    received[ c ].insert( received[ c ].end(), block, block + popped );
+                    poppedTotal.fetch_add( popped, std::memory_order_relaxed );
+                }
+            } );
+        }
+
+        for ( std::thread& t : threads ) {
+            t.join();
+        }
+
+        std::vector<uint8_t> seen( total, 0 );
+        for ( uint32_t c = 0; c < consumerCount; ++c )
+        {
+            uint32_t lastSeq[ producerCount ] = {};
+            bool first[ producerCount ] = { true, true, true, true };
+            for ( const uint64_t value : received[ c ] )
+            {
+                const uint32_t producer = static_cast<uint32_t>( value >> 32 );
+                const uint32_t seq = static_cast<uint32_t>( value & 0xFFFFFFFF );
+                assert( producer < producerCount && seq < perProducer );
+
+                // A single consumer sees each producer's values in push order
+                assert( first[ producer ] || ( seq > lastSeq[ producer ] ) );
+                first[ producer ] = false;
+                lastSeq[ producer ] = seq;
+
+                uint8_t& count = seen[ static_cast<uint64_t>( producer ) * perProducer + seq ];
+                assert( count == 0 );
+                ++count;
+            }
+        }
+        for ( uint64_t i = 0; i < total; ++i ) {
+            assert( seen[ i ] == 1 );
+        }
+        assert( poppedTotal.load() == total );
+        assert( q.Count() == 0 );
+    }
+}
+
+
+void BenchmarkMpmcQueue()
+{
+    const uint32_t maxThreads = std::max( 2u, std::thread::hardware_concurrency() );
+    const uint32_t opsPerThread = 1 << 20;
+
+    for ( uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2 )
+    {
+        static MpmcQueue<uint32_t, 1024> q;
+
+        Timer timer( "MpmcQueue", timerPrecision_t::MICROSECOND );
+
+        // Every thread both produces and consumes, as job workers do
+        std::vector<std::thread> threads;
+        for ( uint32_t t = 0; t < threadCount; ++t )
+        {
+            threads.emplace_back( [&]() {
+                uint32_t value = 0;
+                for ( uint32_t i = 0; i < opsPerThread; ++i )
+                {
+                    while ( !q.TryPush( i ) ) {
+                        std::this_thread::yield();
+                    }
+                    while ( !q.TryPop( value ) ) {
+                        std::this_thread::yield();
+                    }
+                }
+            } );
+        }
+        for ( std::thread& t : threads ) {
+            t.join();
+        }
+        timer.Stop();
+
+        const uint64_t totalOps = 2ull * opsPerThread * threadCount;
+        const uint64_t elapsedUs = std::max<uint64_t>( 1, timer.GetElapsed() );
+        std::cout << "MpmcQueue " << threadCount << " threads: " << ( totalOps / elapsedUs ) << "M ops/s" << std::endl;
+    }
+}
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "common.h"
+
+namespace SysCore
+{
+void TestMpmcQueue();
+void BenchmarkMpmcQueue();
+
+// Bounded multi-producer/multi-consumer queue (Vyukov). Every cell carries a
+// sequence number that says whose turn it is: producers wait for sequence == pos,
+// consumers for sequence == pos + 1. Claiming a position is one CAS on the shared
+// enqueue/dequeue index; batches claim several ready cells with the same CAS.
+template<class T, uint32_t N>
+class MpmcQueue
+{
+private:
+	static_assert( ( N > 1 ) && ( ( N & ( N - 1 ) ) == 0 ), "MpmcQueue capacity must be a power of two" );
+
+	static constexpr uint64_t Mask = N - 1;
+
+	struct cell_t
+	{
+		std::atomic<uint64_t>	sequence;
+		T						data;
+	};
+
+	alignas( CACHE_LINE_SIZE ) std::atomic<uint64_t>	enqueuePos;
+	alignas( CACHE_LINE_SIZE ) std::atomic<uint64_t>	dequeuePos;
+	alignas( CACHE_LINE_SIZE ) cell_t					cells[ N ];
+
+	// Claims up to maxCount cells starting at the shared position. Ready cells
+	// have sequence == pos + offset. Returns the claimed count and first position
+	inline uint32_t Claim( std::atomic<uint64_t>& position, const uint64_t offset, const uint32_t maxCount, uint64_t& outPos )
+	{
+		uint64_t pos = position.load( std::memory_order_relaxed );
+		for ( ;; )
+		{
+			uint32_t readyCount = 0;
+			while ( readyCount < maxCount )
+			{
+				const uint64_t cellPos = pos + readyCount;
+				const uint64_t sequence = cells[ cellPos & Mask ].sequence.load( std::memory_order_acquire );
+				if ( sequence != ( cellPos + offset ) ) {
+					break;
+				}
+				++readyCount;
+			}
+
+			if ( readyCount == 0 )
+			{
+				const uint64_t sequence = cells[ pos & Mask ].sequence.load( std::memory_order_acquire );
+				const int64_t diff = static_cast<int64_t>( sequence - ( pos + offset ) );
+				if ( diff < 0 ) {
+					return 0; // Full for producers, empty for consumers
+				}
+				// Another thread claimed this position, catch up
+				pos = position.load( std::memory_order_relaxed );
+				continue;
+			}
+
+			if ( position.compare_exchange_weak( pos, pos + readyCount, std::memory_order_relaxed ) )
+			{
+				outPos = pos;
+				return readyCount;
+			}
+		}
+	}
+
+public:
+
+	MpmcQueue() : enqueuePos( 0 ), dequeuePos( 0 )
+	{
+		for ( uint32_t i = 0; i < N; ++i ) {
+			cells[ i ].sequence.store( i, std::memory_order_relaxed );
+		}
+	}
+
+	MpmcQueue( const MpmcQueue& ) = delete;
+	MpmcQueue& operator=( const MpmcQueue& ) = delete;
+
+	template<typename U>
+	inline bool TryPush( U&& element )
+	{
+		uint64_t pos;
+		if ( Claim( enqueuePos, 0, 1, pos ) == 0 ) {
+			return false;
+		}
+
+		cell_t& cell = cells[ pos & Mask ];
+		cell.data = std::forward<U>( element );
+		cell.sequence.store( pos + 1, std::memory_order_release );
+		return true;
+	}
+
+	inline bool TryPop( T& outElement )
+	{
+		uint64_t pos;
+		if ( Claim( dequeuePos, 1, 1, pos ) == 0 ) {
+			return false;
+		}
+
+		cell_t& cell = cells[ pos & Mask ];
+		outElement = std::move( cell.data );
+		cell.sequence.store( pos + N, std::memory_order_release );
+		return true;
+	}
+
+	// Pushes up to elementCount elements with a single claim, returns the count pushed
+	inline uint32_t TryPushN( const T* src, const uint32_t elementCount )
+	{
+		uint64_t pos;
+		const uint32_t pushCount = Claim( enqueuePos, 0, std::min( elementCount, N ), pos );
+		for ( uint32_t i = 0; i < pushCount; ++i )
+		{
+			cell_t& cell = cells[ ( pos + i ) & Mask ];
+			cell.data = src[ i ];
+			cell.sequence.store( pos + i + 1, std::memory_order_release );
+		}
+		return pushCount;
+	}
+
+	// Pops up to maxCount elements with a single claim, returns the count popped
+	inline uint32_t TryPopN( T* dst, const uint32_t maxCount )
+	{
+		uint64_t pos;
+		const uint32_t popCount = Claim( dequeuePos, 1, std::min( maxCount, N ), pos );
+		for ( uint32_t i = 0; i < popCount; ++i )
+		{
+			cell_t& cell = cells[ ( pos + i ) & Mask ];
+			dst[ i ] = std::move( cell.data );
+			cell.sequence.store( pos + i + N, std::memory_order_release );
+		}
+		return popCount;
+	}
+
+	// Approximate when other threads are active
+	inline uint32_t Count() const
+	{
+		const uint64_t readPos = dequeuePos.load( std::memory_order_acquire );
+		const uint64_t writePos = enqueuePos.load( std::memory_order_acquire );
+		return ( writePos > readPos ) ? static_cast<uint32_t>( std::min<uint64_t>( writePos - readPos, N ) ) : 0;
+	}
+
+	inline uint32_t Capacity() const
+	{
+		return N;
+	}
+};
+}
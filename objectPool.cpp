@@ -0,0 +1,465 @@
+#include "objectPool.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+#include <thread>
+
+#include "timer.h"
+
+namespace SysCore
+{
+// Pools alive right now, so exiting threads only hand magazines back to pools
+// that still exist. Ids are never reused
+struct poolRegistry_t
+{
+	std::mutex						lock;
+	std::vector<PoolAllocator*>		pools;
+	uint64_t						nextId = 1;
+};
+
+
+static poolRegistry_t& PoolRegistry()
+{
+	static poolRegistry_t registry;
+	return registry;
+}
+
+
+static uint64_t RegisterPool( PoolAllocator* pool )
+{
+	poolRegistry_t& registry = PoolRegistry();
+	std::lock_guard<std::mutex> guard( registry.lock );
+	registry.pools.push_back( pool );
+	return registry.nextId++;
+}
+
+
+struct threadPoolCache_t
+{
+	struct entry_t
+	{
+		uint64_t					poolId;
+		PoolAllocator::magazine_t*	magazine;
+	};
+
+	std::vector<entry_t>	entries;
+	entry_t					last = { 0, nullptr };
+
+	inline PoolAllocator::magazine_t* Find( const uint64_t poolId )
+	{
+		if ( last.poolId == poolId ) {
+			return last.magazine;
+		}
+		for ( const entry_t& entry : entries )
+		{
+			if ( entry.poolId == poolId )
+			{
+				last = entry;
+				return entry.magazine;
+			}
+		}
+		return nullptr;
+	}
+
+	~threadPoolCache_t()
+	{
+		poolRegistry_t& registry = PoolRegistry();
+		std::lock_guard<std::mutex> guard( registry.lock );
+		for ( const entry_t& entry : entries )
+		{
+			for ( PoolAllocator* pool : registry.pools )
+			{
+				if ( pool->id == entry.poolId )
+				{
+					pool->ReleaseMagazine( entry.magazine );
+					break;
+				}
+			}
+		}
+	}
+};
+
+
+static thread_local threadPoolCache_t threadPoolCache;
+
+
+PoolAllocator::PoolAllocator( const uint32_t _blockSize, const uint32_t alignment, const uint32_t _blocksPerSlab, const memTag_t _tag )
+	: id( RegisterPool( this ) ), freeHead( nullptr ), sharedCount( 0 )
+{
+	assert( ( alignment > 0 ) && ( ( alignment & ( alignment - 1 ) ) == 0 ) );
+
+	const uint32_t blockAlignment = std::max<uint32_t>( alignment, alignof( freeBlock_t ) );
+	const uint32_t minSize = std::max<uint32_t>( _blockSize, sizeof( freeBlock_t ) );
+
+	blockSize = _blockSize;
+	blockStride = ( minSize + blockAlignment - 1 ) & ~( blockAlignment - 1 );
+	slabAlignment = std::max<uint32_t>( blockAlignment, CACHE_LINE_SIZE );
+	blocksPerSlab = std::max<uint32_t>( _blocksPerSlab, 1 );
+	tag = _tag;
+}
+
+
+PoolAllocator::~PoolAllocator()
+{
+	{
+		poolRegistry_t& registry = PoolRegistry();
+		std::lock_guard<std::mutex> guard( registry.lock );
+		registry.pools.erase( std::find( registry.pools.begin(), registry.pools.end(), this ) );
+	}
+
+	for ( uint8_t* slab : slabs )
+	{
+		MEM_TRACK_FREE( tag, static_cast<uint64_t>( blockStride ) * blocksPerSlab );
+		::operator delete( slab, std::align_val_t( slabAlignment ) );
+	}
+	for ( magazine_t* magazine : magazines ) {
+		delete magazine;
+	}
+}
+
+
+PoolAllocator::magazine_t* PoolAllocator::ThreadMagazine()
+{
+	magazine_t* magazine = threadPoolCache.Find( id );
+	if ( magazine == nullptr )
+	{
+		magazine = AcquireMagazine();
+
+		// Drop entries for pools that have since been destroyed
+		{
+			poolRegistry_t& registry = PoolRegistry();
+			std::lock_guard<std::mutex> guard( registry.lock );
+			std::vector<threadPoolCache_t::entry_t>& entries = threadPoolCache.entries;
+			entries.erase( std::remove_if( entries.begin(), entries.end(), [&]( const threadPoolCache_t::entry_t& entry ) {
+				return std::none_of( registry.pools.begin(), registry.pools.end(), [&]( const PoolAllocator* pool ) {
+					return ( pool->id == entry.poolId );
+				} );
+			} ), entries.end() );
+		}
+
+		threadPoolCache.entries.push_back( { id, magazine } );
+		threadPoolCache.last = { id, magazine };
+	}
+	return magazine;
+}
+
+
+PoolAllocator::magazine_t* PoolAllocator::AcquireMagazine()
+{
+	std::lock_guard<std::mutex> guard( lock );
+
+	// Reuse magazines left behind by exited threads, their counters carry over
+	for ( magazine_t* magazine : magazines )
+	{
+		if ( magazine->inUse == false )
+		{
+			magazine->inUse = true;
+			return magazine;
+		}
+	}
+
+	magazine_t* magazine = new magazine_t();
+	magazine->count = 0;
+	magazine->inUse = true;
+	magazine->allocCount.store( 0, std::memory_order_relaxed );
+	magazine->freeCount.store( 0, std::memory_order_relaxed );
+	magazine->hits.store( 0, std::memory_order_relaxed );
+	magazine->misses.store( 0, std::memory_order_relaxed );
+	magazines.push_back( magazine );
+	return magazine;
+}
+
+
+void PoolAllocator::ReleaseMagazine( magazine_t* magazine )
+{
+	Flush( *magazine, 0 );
+	std::lock_guard<std::mutex> guard( lock );
+	magazine->inUse = false;
+}
+
+
+void PoolAllocator::AllocateSlab()
+{
+	const size_t slabBytes = static_cast<size_t>( blockStride ) * blocksPerSlab;
+	uint8_t* slab = static_cast<uint8_t*>( ::operator new( slabBytes, std::align_val_t( slabAlignment ) ) );
+	slabs.push_back( slab );
+	MEM_TRACK_ALLOC( tag, slabBytes );
+
+	// Link back to front so blocks come out in address order
+	for ( uint32_t i = blocksPerSlab; i > 0; --i )
+	{
+		freeBlock_t* block = reinterpret_cast<freeBlock_t*>( slab + static_cast<size_t>( i - 1 ) * blockStride );
+		block->next = freeHead;
+		freeHead = block;
+	}
+	sharedCount += blocksPerSlab;
+}
+
+
+void PoolAllocator::Refill( magazine_t& magazine )
+{
+	std::lock_guard<std::mutex> guard( lock );
+	if ( freeHead == nullptr ) {
+		AllocateSlab();
+	}
+
+	while ( ( magazine.count < ( MagazineSize / 2 ) ) && ( freeHead != nullptr ) )
+	{
+		magazine.blocks[ magazine.count++ ] = freeHead;
+		freeHead = freeHead->next;
+		--sharedCount;
+	}
+}
+
+
+void PoolAllocator::Flush( magazine_t& magazine, const uint32_t keepCount )
+{
+	std::lock_guard<std::mutex> guard( lock );
+	while ( magazine.count > keepCount )
+	{
+		freeBlock_t* block = static_cast<freeBlock_t*>( magazine.blocks[ --magazine.count ] );
+		block->next = freeHead;
+		freeHead = block;
+		++sharedCount;
+	}
+}
+
+
+void* PoolAllocator::Allocate()
+{
+	magazine_t& magazine = *ThreadMagazine();
+	if ( magazine.count == 0 )
+	{
+		magazine.misses.store( magazine.misses.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+		Refill( magazine );
+	}
+	else
+	{
+		magazine.hits.store( magazine.hits.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+	}
+
+	magazine.allocCount.store( magazine.allocCount.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+	return magazine.blocks[ --magazine.count ];
+}
+
+
+void PoolAllocator::Free( void* block )
+{
+	if ( block == nullptr ) {
+		return;
+	}
+
+	magazine_t& magazine = *ThreadMagazine();
+	if ( magazine.count == MagazineSize )
+	{
+		magazine.misses.store( magazine.misses.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+		Flush( magazine, MagazineSize / 2 );
+	}
+	else
+	{
+		magazine.hits.store( magazine.hits.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+	}
+
+	magazine.freeCount.store( magazine.freeCount.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+	magazine.blocks[ magazine.count++ ] = block;
+}
+
+
+void PoolAllocator::FlushThreadCache()
+{
+	magazine_t* magazine = threadPoolCache.Find( id );
+	if ( magazine != nullptr ) {
+		Flush( *magazine, 0 );
+	}
+}
+
+
+poolStats_t PoolAllocator::Stats() const
+{
+	std::lock_guard<std::mutex> guard( lock );
+
+	poolStats_t stats = {};
+	stats.blockSize = blockSize;
+	stats.blocksPerSlab = blocksPerSlab;
+	stats.slabCount = static_cast<uint32_t>( slabs.size() );
+	stats.sharedCount = sharedCount;
+
+	uint64_t allocCount = 0;
+	uint64_t freeCount = 0;
+	for ( const magazine_t* magazine : magazines )
+	{
+		allocCount += magazine->allocCount.load( std::memory_order_relaxed );
+		freeCount += magazine->freeCount.load( std::memory_order_relaxed );
+		stats.cacheHits += magazine->hits.load( std::memory_order_relaxed );
+		stats.cacheMisses += magazine->misses.load( std::memory_order_relaxed );
+	}
+	stats.liveCount = allocCount - freeCount;
+
+	const uint64_t totalBlocks = static_cast<uint64_t>( stats.slabCount ) * blocksPerSlab;
+	stats.cachedCount = totalBlocks - stats.liveCount - stats.sharedCount;
+	return stats;
+}
+
+
+static uint32_t poolTestLiveCount = 0;
+
+struct poolTestObject_t
+{
+    uint64_t    a;
+    uint32_t    b;
+
+    poolTestObject_t( const uint64_t _a, const uint32_t _b ) : a( _a ), b( _b ) { ++poolTestLiveCount; }
+    ~poolTestObject_t() { --poolTestLiveCount; }
+};
+
+
+void TestObjectPool()
+{
+
+    // --- Construct, destroy and reuse ---
+    {
+        ObjectPool<poolTestObject_t> pool( 16 );
+        poolTestObject_t* first = pool.New( 1ull, 2u );
+        assert( first->a == 1 && first->b == 2 );
+        assert( poolTestLiveCount == 1 );
+
+        pool.Delete( first );
+        assert( poolTestLiveCount == 0 );
+
+        // The magazine hands the same block straight back
+        poolTestObject_t* second = pool.New( 3ull, 4u );
+        assert( second == first );
+        pool.Delete( second );
+        pool.Delete( nullptr );
+    }
+
+    // --- Slabs, alignment and stats ---
+    {
+        struct alignas( 32 ) aligned_t { uint8_t bytes[ 40 ]; };
+
+        ObjectPool<aligned_t> pool( 8 );
+        std::vector<aligned_t*> objects;
+        for ( uint32_t i = 0; i < 100; ++i )
+        {
+            objects.push_back( pool.New() );
+            assert( ( reinterpret_cast<uintptr_t>( objects.back() ) & 31 ) == 0 );
+        }
+        std::sort( objects.begin(), objects.end() );
+        assert( std::adjacent_find( objects.begin(), objects.end() ) == objects.end() );
+
+        poolStats_t stats = pool.Stats();
+        assert( stats.blockSize == sizeof( aligned_t ) );
+        assert( stats.liveCount == 100 );
+        assert( stats.slabCount * stats.blocksPerSlab >= 100 );
+        assert( stats.cacheHits > stats.cacheMisses );
+
+        for ( aligned_t* object : objects ) {
+            pool.Delete( object );
+        }
+        stats = pool.Stats();
+        assert( stats.liveCount == 0 );
+        assert( stats.cachedCount > 0 );
+
+        pool.FlushThreadCache();
+        stats = pool.Stats();
+        assert( stats.cachedCount == 0 );
+        assert( stats.sharedCount == stats.slabCount * stats.blocksPerSlab );
+    }
+
+    // --- Threads allocate, free each other's blocks, then exit ---
+    {
+        ObjectPool<uint64_t> pool;
+        const uint32_t threadCount = 4;
+        const uint32_t perThread = 10000;
+        std::vector<std::vector<uint64_t*>> allocated( threadCount );
+
+        std::vector<std::thread> threads;
+        for ( uint32_t t = 0; t < threadCount; ++t )
+        {
+            threads.emplace_back( [&, t]() {
+                for ( uint32_t i = 0; i < perThread; ++i ) {
+                    allocated[ t ].push_back( pool.New( static_cast<uint64_t>( t ) * perThread + i ) );
+                }
+            } );
+        }
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+        threads.clear();
+
+        for ( uint32_t t = 0; t < threadCount; ++t )
+        {
+            threads.emplace_back( [&, t]() {
+                for ( uint64_t* value : allocated[ ( t + 1 ) % threadCount ] )
+                {
+                    assert( *value / perThread == ( t + 1 ) % threadCount );
+                    pool.Delete( value );
+                }
+            } );
+        }
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+
+        // Exited threads gave their magazines back
+        const poolStats_t stats = pool.Stats();
+        assert( stats.liveCount == 0 );
+        assert( stats.cachedCount == 0 );
+    }
+}
+
+
+void BenchmarkObjectPool()
+{
+    const uint32_t maxThreads = std::max( 2u, std::thread::hardware_concurrency() );
+    const uint32_t batchSize = 256;
+    const uint32_t batchCount = 4096;
+
+    struct payload_t { uint64_t values[ 4 ]; };
+
+    for ( uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2 )
+    {
+        ObjectPool<payload_t> pool;
+        uint64_t elapsed[ 2 ] = {};
+
+        for ( uint32_t mode = 0; mode < 2; ++mode )
+        {
+            Timer timer( "ObjectPool", timerPrecision_t::MICROSECOND );
+
+            std::vector<std::thread> threads;
+            for ( uint32_t t = 0; t < threadCount; ++t )
+            {
+                threads.emplace_back( [&]() {
+                    payload_t* batch[ batchSize ];
+                    for ( uint32_t i = 0; i < batchCount; ++i )
+                    {
+                        for ( uint32_t j = 0; j < batchSize; ++j ) {
+                            batch[ j ] = ( mode == 0 ) ? new payload_t() : pool.New();
+                        }
+                        for ( uint32_t j = 0; j < batchSize; ++j )
+                        {
+                            if ( mode == 0 ) {
+                                delete batch[ j ];
+                            } else {
+                                pool.Delete( batch[ j ] );
+                            }
+                        }
+                    }
+                } );
+            }
+            for ( std::thread& thread : threads ) {
+                thread.join();
+            }
+            timer.Stop();
+            elapsed[ mode ] = std::max<uint64_t>( 1, timer.GetElapsed() );
+        }
+
+        const uint64_t totalOps = 2ull * batchSize * batchCount * threadCount;
+        const poolStats_t stats = pool.Stats();
+        std::cout << "ObjectPool " << threadCount << " threads: new/delete " << ( totalOps / elapsed[ 0 ] ) << "M ops/s, pool "
+            << ( totalOps / elapsed[ 1 ] ) << "M ops/s, " << stats.slabCount << " slabs, hit rate "
+            << ( 100 * stats.cacheHits / std::max<uint64_t>( 1, stats.cacheHits + stats.cacheMisses ) ) << "%" << std::endl;
+    }
+}
+}
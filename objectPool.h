@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+#include "memTracker.h"
+
+namespace SysCore
+{
+void TestObjectPool();
+void BenchmarkObjectPool();
+
+struct poolStats_t
+{
+	uint32_t	blockSize;
+	uint32_t	blocksPerSlab;
+	uint32_t	slabCount;
+	uint64_t	liveCount;		// Blocks handed out and not yet freed
+	uint64_t	cachedCount;	// Free blocks sitting in per-thread magazines
+	uint64_t	sharedCount;	// Free blocks on the shared list
+	uint64_t	cacheHits;		// Allocations/frees served by the thread's magazine
+	uint64_t	cacheMisses;	// Allocations/frees that had to take the shared lock
+};
+
+
+// Fixed-size block allocator. Blocks are carved out of large slabs and linked
+// through an intrusive free list. Each thread keeps a small magazine of free
+// blocks so most Allocate()/Free() calls never touch the shared lock; magazines
+// are refilled from and flushed to the shared list in half-magazine batches.
+// A thread's magazine is handed back to the pool when the thread exits.
+// Slabs are only returned to the system when the pool is destroyed.
+class PoolAllocator
+{
+public:
+	static const uint32_t DefaultBlocksPerSlab = 256;
+	static const uint32_t MagazineSize = 64;
+
+private:
+	struct freeBlock_t
+	{
+		freeBlock_t*	next;
+	};
+
+	struct magazine_t
+	{
+		void*					blocks[ MagazineSize ];
+		uint32_t				count;
+		bool					inUse;
+		// Written by the owning thread only, atomics so Stats() can read them
+		std::atomic<uint64_t>	allocCount;
+		std::atomic<uint64_t>	freeCount;
+		std::atomic<uint64_t>	hits;
+		std::atomic<uint64_t>	misses;
+	};
+
+	friend struct threadPoolCache_t;
+
+	const uint64_t				id;
+	uint32_t					blockSize;
+	uint32_t					blockStride;
+	uint32_t					slabAlignment;
+	uint32_t					blocksPerSlab;
+	memTag_t					tag;
+
+	mutable std::mutex			lock;
+	freeBlock_t*				freeHead;
+	uint64_t					sharedCount;
+	std::vector<uint8_t*>		slabs;
+	std::vector<magazine_t*>	magazines;
+
+	magazine_t*	ThreadMagazine();
+	magazine_t*	AcquireMagazine();
+	void		ReleaseMagazine( magazine_t* magazine );
+	void		Refill( magazine_t& magazine );
+	void		Flush( magazine_t& magazine, const uint32_t keepCount );
+	void		AllocateSlab();
+
+public:
+	PoolAllocator( const uint32_t blockSize, const uint32_t alignment, const uint32_t blocksPerSlab = DefaultBlocksPerSlab, const memTag_t tag = memTag_t::POOL );
+	~PoolAllocator();
+
+	PoolAllocator( const PoolAllocator& ) = delete;
+	PoolAllocator& operator=( const PoolAllocator& ) = delete;
+
+	// Throws std::bad_alloc if a new slab can't be allocated
+	void*		Allocate();
+	void		Free( void* block );
+
+	// Moves the calling thread's cached blocks back to the shared list
+	void		FlushThreadCache();
+
+	// Consistent only while no other thread is allocating
+	poolStats_t	Stats() const;
+
+	inline uint32_t BlockSize() const
+	{
+		return blockSize;
+	}
+};
+
+
+// Typed front end for PoolAllocator. The pool does not track live objects, so
+// anything not returned through Delete() is leaked without its destructor running
+template<class T>
+class ObjectPool
+{
+private:
+	PoolAllocator	allocator;
+
+public:
+	ObjectPool( const uint32_t blocksPerSlab = PoolAllocator::DefaultBlocksPerSlab, const memTag_t tag = memTag_t::POOL )
+		: allocator( sizeof( T ), alignof( T ), blocksPerSlab, tag )
+	{}
+
+	template<typename... Args>
+	inline T* New( Args&&... args )
+	{
+		void* mem = allocator.Allocate();
+		return new ( mem ) T( std::forward<Args>( args )... );
+	}
+
+	inline void Delete( T* object )
+	{
+		if ( object != nullptr )
+		{
+			object->~T();
+			allocator.Free( object );
+		}
+	}
+
+	inline void FlushThreadCache()
+	{
+		allocator.FlushThreadCache();
+	}
+
+	inline poolStats_t Stats() const
+	{
+		return allocator.Stats();
+	}
+};
+}
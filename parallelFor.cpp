@@ -0,0 +1,241 @@
+#include "parallelFor.h"
+
+#include <assert.h>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#include "timer.h"
+
+namespace SysCore
+{
+// Well above the cost of submitting, stealing and finishing one job
+static const uint64_t MinChunkNs = 20000;
+static const uint32_t ChunksPerThread = 4;
+
+parallelSplit_t ParallelSplit( const uint32_t start, const uint32_t end, const uint32_t threadCount, const uint32_t grainSize,
+	const uint32_t alignment, const uint32_t lead, const uint64_t probeNs, const uint32_t probeCount )
+{
+	assert( ( start < end ) && ( alignment > 0 ) && ( lead < alignment ) );
+
+	const uint64_t remaining = end - start;
+	uint64_t grain = grainSize;
+	if ( grain == 0 )
+	{
+		// Chunks must be worth a job; past that, aim for a few per thread to balance
+		const uint64_t minGrain = ( probeNs > 0 ) ? ( ( MinChunkNs * probeCount ) + probeNs - 1 ) / probeNs : remaining;
+		const uint64_t chunkTarget = static_cast<uint64_t>( threadCount ) * ChunksPerThread;
+		const uint64_t balanceGrain = ( remaining + chunkTarget - 1 ) / chunkTarget;
+		grain = std::max( minGrain, balanceGrain );
+	}
+	grain = std::min<uint64_t>( grain, remaining );
+	grain = std::max<uint64_t>( 1, ( grain + alignment - 1 ) / alignment ) * alignment;
+
+	// Last cache line boundary at or before start
+	const int64_t offset = static_cast<int64_t>( start ) - lead;
+	const int64_t lines = ( offset >= 0 ) ? ( offset / alignment ) : -( ( -offset + alignment - 1 ) / alignment );
+
+	parallelSplit_t split;
+	split.base = lead + ( lines * alignment );
+	split.start = start;
+	split.end = end;
+	split.chunkSize = static_cast<uint32_t>( grain );
+	split.chunkCount = static_cast<uint32_t>( ( ( end - split.base ) + grain - 1 ) / grain );
+	return split;
+}
+
+
+void TestParallelFor()
+{
+    jobSystemConfig_t config;
+    config.workerCount = 3;
+    JobSystem jobs( config );
+
+    // --- Splits cover the range with line-aligned inner boundaries ---
+    {
+        const parallelSplit_t split = ParallelSplit( 5, 1000, 4, 100, 16, 3, 0, 0 );
+        assert( split.chunkSize == 112 );
+        assert( split.Begin( 0 ) == 5 );
+        uint32_t covered = 5;
+        for ( uint32_t c = 0; c < split.chunkCount; ++c )
+        {
+            assert( split.Begin( c ) == covered );
+            assert( split.End( c ) > split.Begin( c ) );
+            if ( c > 0 ) {
+                assert( ( ( split.Begin( c ) - 3 ) % 16 ) == 0 );
+            }
+            covered = split.End( c );
+        }
+        assert( covered == 1000 );
+
+        // Cheap elements make few large chunks, expensive ones make many
+        const parallelSplit_t cheap = ParallelSplit( 0, 1 << 20, 4, 0, 16, 0, 4000, 4000 );
+        const parallelSplit_t costly = ParallelSplit( 0, 1 << 20, 4, 0, 16, 0, 4000, 4 );
+        assert( cheap.chunkSize >= 20000 );
+        assert( costly.chunkCount == 16 );
+    }
+
+    // --- Every index runs exactly once ---
+    for ( const uint32_t grainSize : { 0u, 1u, 1000u } )
+    {
+        const uint32_t first = 17;
+        const uint32_t last = 300000;
+        std::vector<uint32_t> visits( last, 0 );
+        ParallelFor( jobs, first, last, [&visits]( const uint32_t i ) { ++visits[ i ]; }, grainSize );
+        for ( uint32_t i = 0; i < last; ++i ) {
+            assert( visits[ i ] == ( ( i >= first ) ? 1u : 0u ) );
+        }
+    }
+
+    // --- Small loops stay on the calling thread ---
+    {
+        const std::thread::id caller = std::this_thread::get_id();
+        uint32_t ran = 0;
+        ParallelFor( jobs, 0, 64, [&]( const uint32_t ) {
+            assert( std::this_thread::get_id() == caller );
+            ++ran;
+        }, 64 );
+        assert( ran == 64 );
+
+        // Auto grain finishes a loop this small inside the probe
+        std::atomic<uint32_t> autoRan( 0 );
+        ParallelFor( jobs, 0, 64, [&]( const uint32_t ) { autoRan.fetch_add( 1, std::memory_order_relaxed ); } );
+        assert( autoRan.load() == 64 );
+        ParallelFor( jobs, 10, 10, []( const uint32_t ) { assert( 0 ); } );
+    }
+
+    // --- Span from an unaligned start ---
+    {
+        std::vector<uint32_t> values( 100001 );
+        for ( uint32_t i = 0; i < values.size(); ++i ) {
+            values[ i ] = i;
+        }
+        ParallelFor( jobs, values.data() + 1, 100000, []( uint32_t& value ) { value *= 2; }, 256 );
+        assert( values[ 0 ] == 0 );
+        for ( uint32_t i = 1; i < values.size(); ++i ) {
+            assert( values[ i ] == 2 * i );
+        }
+
+        const uint64_t sum = ParallelReduce( jobs, values.data() + 1, 100000, uint64_t( 0 ),
+            []( const uint64_t acc, const uint32_t value ) { return acc + value; },
+            []( const uint64_t a, const uint64_t b ) { return a + b; } );
+        assert( sum == 100000ull * 100001ull );
+    }
+
+    // --- Range reductions ---
+    {
+        const uint64_t sum = ParallelReduce( jobs, 0, 1 << 20, uint64_t( 0 ),
+            []( const uint64_t acc, const uint32_t i ) { return acc + i; },
+            []( const uint64_t a, const uint64_t b ) { return a + b; }, 4096 );
+        assert( sum == ( ( 1ull << 20 ) * ( ( 1ull << 20 ) - 1 ) ) / 2 );
+
+        const bool found = ParallelReduce( jobs, 0, 500000, false,
+            []( const bool acc, const uint32_t i ) { return acc || ( i == 499999 ); },
+            []( const bool a, const bool b ) { return a || b; }, 1000 );
+        assert( found );
+
+        assert( ParallelReduce( jobs, 5, 5, 7, []( int acc, uint32_t ) { return acc; }, []( int a, int b ) { return a + b; } ) == 7 );
+    }
+
+    // --- Set bits of a BitArray ---
+    {
+        BitArray bits( 200000 );
+        uint64_t expectedSum = 0;
+        for ( uint32_t i = 0; i < bits.Size(); i += ( ( i % 7 ) + 1 ) )
+        {
+            bits.Set( i );
+            expectedSum += i;
+        }
+
+        std::vector<uint8_t> visits( bits.Size(), 0 );
+        ParallelForSetBits( jobs, bits, [&visits]( const uint32_t bit ) { ++visits[ bit ]; }, 16 );
+        for ( uint32_t i = 0; i < bits.Size(); ++i ) {
+            assert( visits[ i ] == ( bits.IsSet( i ) ? 1 : 0 ) );
+        }
+
+        const uint64_t sum = ParallelReduceSetBits( jobs, bits, uint64_t( 0 ),
+            []( const uint64_t acc, const uint32_t bit ) { return acc + bit; },
+            []( const uint64_t a, const uint64_t b ) { return a + b; } );
+        assert( sum == expectedSum );
+
+        const uint32_t count = ParallelReduceSetBits( jobs, bits, 0u,
+            []( const uint32_t acc, const uint32_t ) { return acc + 1; },
+            []( const uint32_t a, const uint32_t b ) { return a + b; }, 8 );
+        assert( count == bits.Count() );
+    }
+
+    // --- No workers runs serially ---
+    {
+        jobSystemConfig_t serialConfig;
+        serialConfig.workerCount = 0;
+        JobSystem serialJobs( serialConfig );
+        const uint64_t sum = ParallelReduce( serialJobs, 0, 10000, uint64_t( 0 ),
+            []( const uint64_t acc, const uint32_t i ) { return acc + i; },
+            []( const uint64_t a, const uint64_t b ) { return a + b; }, 100 );
+        assert( sum == ( 10000ull * 9999ull ) / 2 );
+    }
+}
+
+
+void BenchmarkParallelFor()
+{
+    const uint32_t count = 1 << 24;
+    const uint32_t coreCount = std::max( 2u, std::thread::hardware_concurrency() );
+
+    std::vector<float> values( count );
+    auto fill = [&values]() {
+        for ( uint32_t i = 0; i < static_cast<uint32_t>( values.size() ); ++i ) {
+            values[ i ] = static_cast<float>( i % 1024 ) * 0.001f;
+        }
+    };
+
+    auto transform = []( float& value ) { value = std::sqrt( value * value + 1.0f ); };
+    auto sumSquares = []( const double acc, const float value ) { return acc + static_cast<double>( value ) * value; };
+    auto add = []( const double a, const double b ) { return a + b; };
+
+    uint64_t serialForUs = 1;
+    uint64_t serialReduceUs = 1;
+    {
+        fill();
+        Timer timer( "Serial", timerPrecision_t::MICROSECOND );
+        for ( float& value : values ) {
+            transform( value );
+        }
+        timer.Stop();
+        serialForUs = std::max<uint64_t>( 1, timer.GetElapsed() );
+
+        timer.Start();
+        double sum = 0.0;
+        for ( const float value : values ) {
+            sum = sumSquares( sum, value );
+        }
+        timer.Stop();
+        serialReduceUs = std::max<uint64_t>( 1, timer.GetElapsed() );
+        std::cout << "Serial over " << count << " floats: transform " << serialForUs << "us, sum of squares " << serialReduceUs
+            << "us (" << sum << ")" << std::endl;
+    }
+
+    for ( uint32_t threadCount = 1; threadCount <= coreCount; threadCount *= 2 )
+    {
+        jobSystemConfig_t config;
+        config.workerCount = threadCount - 1;
+        JobSystem jobs( config );
+        fill();
+
+        Timer timer( "ParallelFor", timerPrecision_t::MICROSECOND );
+        ParallelFor( jobs, values.data(), count, transform );
+        timer.Stop();
+        const uint64_t forUs = std::max<uint64_t>( 1, timer.GetElapsed() );
+
+        timer.Start();
+        const double sum = ParallelReduce( jobs, values.data(), count, 0.0, sumSquares, add );
+        timer.Stop();
+        const uint64_t reduceUs = std::max<uint64_t>( 1, timer.GetElapsed() );
+
+        std::cout << "Parallel " << threadCount << " threads: transform " << forUs << "us ("
+            << ( static_cast<double>( serialForUs ) / forUs ) << "x), sum of squares " << reduceUs << "us ("
+            << ( static_cast<double>( serialReduceUs ) / reduceUs ) << "x, " << sum << ")" << std::endl;
+    }
+}
+}
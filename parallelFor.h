@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "bitArray.h"
+#include "bitIterator.h"
+#include "common.h"
+#include "jobSystem.h"
+#include "timer.h"
+
+namespace SysCore
+{
+void TestParallelFor();
+void BenchmarkParallelFor();
+
+// Data-parallel loops on top of JobSystem. With no grain size given, the calling
+// thread first runs a short probe of the loop, doubling the batch until it has
+// taken a few microseconds, and sizes chunks from the measured per-element cost:
+// big enough to amortize a job, small enough to give every thread several to
+// balance with. Loops that finish inside the probe, or that would fit in one
+// chunk, never leave the calling thread.
+//
+// Chunk boundaries fall on cache lines of the data being walked, so neighbouring
+// chunks never write the same line. The caller runs the first chunk itself and
+// helps with the rest while it waits.
+
+// Chunking of [start, end). Chunk c covers [Begin( c ), End( c )), every boundary
+// after the first is base plus a multiple of chunkSize
+struct parallelSplit_t
+{
+	int64_t		base;
+	uint32_t	start;
+	uint32_t	end;
+	uint32_t	chunkSize;
+	uint32_t	chunkCount;
+
+	inline uint32_t Begin( const uint32_t chunkIx ) const
+	{
+		return ( chunkIx == 0 ) ? start : static_cast<uint32_t>( base + static_cast<int64_t>( chunkIx ) * chunkSize );
+	}
+
+	inline uint32_t End( const uint32_t chunkIx ) const
+	{
+		return static_cast<uint32_t>( std::min<int64_t>( end, base + static_cast<int64_t>( chunkIx + 1 ) * chunkSize ) );
+	}
+};
+
+// Splits [start, end) for threadCount threads. A grainSize of 0 sizes chunks from
+// the probe timing. Chunk sizes are multiples of alignment and boundaries sit on
+// lead + n * alignment
+parallelSplit_t	ParallelSplit( const uint32_t start, const uint32_t end, const uint32_t threadCount, const uint32_t grainSize,
+					const uint32_t alignment, const uint32_t lead, const uint64_t probeNs, const uint32_t probeCount );
+
+// Elements of T per cache line when T packs evenly into one, otherwise 1
+template<class T>
+inline constexpr uint32_t ParallelAlignment()
+{
+	return ( ( sizeof( T ) <= CACHE_LINE_SIZE ) && ( ( CACHE_LINE_SIZE % sizeof( T ) ) == 0 ) ) ? static_cast<uint32_t>( CACHE_LINE_SIZE / sizeof( T ) ) : 1;
+}
+
+// Elements before data reaches the next cache line
+template<class T>
+inline uint32_t ParallelLead( const T* data )
+{
+	const uintptr_t address = reinterpret_cast<uintptr_t>( data );
+	if ( ( ParallelAlignment<T>() == 1 ) || ( ( address % sizeof( T ) ) != 0 ) ) {
+		return 0;
+	}
+	return static_cast<uint32_t>( ( ( CACHE_LINE_SIZE - ( address % CACHE_LINE_SIZE ) ) % CACHE_LINE_SIZE ) / sizeof( T ) );
+}
+
+
+// Runs chunk( begin, end ) over [0, count), returning how far the probe got
+template<typename Chunk>
+inline uint32_t ParallelProbe( const uint32_t count, const uint32_t alignment, Chunk& chunk, uint64_t& outProbeNs )
+{
+	static const uint64_t ProbeNs = 4000;
+
+	const uint64_t probeStart = MonotonicNowNs();
+	uint32_t probed = 0;
+	uint32_t batch = alignment;
+	outProbeNs = 0;
+	while ( ( probed < count ) && ( outProbeNs < ProbeNs ) )
+	{
+		const uint32_t batchEnd = probed + std::min( batch, count - probed );
+		chunk( probed, batchEnd );
+		probed = batchEnd;
+		outProbeNs = MonotonicNowNs() - probeStart;
+		batch = ( batch < ( 1u << 30 ) ) ? ( 2 * batch ) : batch;
+	}
+	return probed;
+}
+
+
+template<typename Chunk>
+void ParallelForChunks( JobSystem& jobs, const uint32_t count, const uint32_t alignment, const uint32_t lead, const uint32_t grainSize, Chunk&& chunk )
+{
+	const uint32_t threadCount = jobs.WorkerCount() + 1;
+	if ( ( threadCount == 1 ) || ( count <= std::max( grainSize, 1u ) ) )
+	{
+		if ( count > 0 ) {
+			chunk( 0u, count );
+		}
+		return;
+	}
+
+	uint64_t probeNs = 0;
+	const uint32_t probed = ( grainSize == 0 ) ? ParallelProbe( count, alignment, chunk, probeNs ) : 0;
+	if ( probed == count ) {
+		return;
+	}
+
+	const parallelSplit_t split = ParallelSplit( probed, count, threadCount, grainSize, alignment, lead, probeNs, probed );
+	if ( split.chunkCount == 1 )
+	{
+		chunk( split.start, split.end );
+		return;
+	}
+
+	JobCounter counter;
+	for ( uint32_t chunkIx = 1; chunkIx < split.chunkCount; ++chunkIx ) {
+		jobs.Submit( counter, [&chunk, &split, chunkIx]() { chunk( split.Begin( chunkIx ), split.End( chunkIx ) ); } );
+	}
+	chunk( split.Begin( 0 ), split.End( 0 ) );
+	jobs.Wait( counter );
+}
+
+
+// Chunks return their partial result, partials are combined in index order
+template<typename T, typename Chunk, typename Combine>
+T ParallelReduceChunks( JobSystem& jobs, const uint32_t count, const uint32_t alignment, const uint32_t lead, const uint32_t grainSize,
+	const T& identity, Chunk&& chunk, Combine&& combine )
+{
+	const uint32_t threadCount = jobs.WorkerCount() + 1;
+	if ( ( threadCount == 1 ) || ( count <= std::max( grainSize, 1u ) ) ) {
+		return ( count > 0 ) ? combine( identity, chunk( 0u, count ) ) : identity;
+	}
+
+	T result = identity;
+	uint64_t probeNs = 0;
+	uint32_t probed = 0;
+	if ( grainSize == 0 )
+	{
+		auto probeChunk = [&]( const uint32_t begin, const uint32_t end ) { result = combine( result, chunk( begin, end ) ); };
+		probed = ParallelProbe( count, alignment, probeChunk, probeNs );
+		if ( probed == count ) {
+			return result;
+		}
+	}
+
+	const parallelSplit_t split = ParallelSplit( probed, count, threadCount, grainSize, alignment, lead, probeNs, probed );
+	if ( split.chunkCount == 1 ) {
+		return combine( result, chunk( split.start, split.end ) );
+	}
+
+	// Wrapped so vector<bool> can't pack partials from different threads into one word
+	struct partial_t
+	{
+		T value;
+	};
+	std::vector<partial_t> partials( split.chunkCount, partial_t{ identity } );
+
+	JobCounter counter;
+	for ( uint32_t chunkIx = 1; chunkIx < split.chunkCount; ++chunkIx )
+	{
+		jobs.Submit( counter, [&chunk, &split, &partials, chunkIx]() {
+			partials[ chunkIx ].value = chunk( split.Begin( chunkIx ), split.End( chunkIx ) );
+		} );
+	}
+	partials[ 0 ].value = chunk( split.Begin( 0 ), split.End( 0 ) );
+	jobs.Wait( counter );
+
+	for ( const partial_t& partial : partials ) {
+		result = combine( result, partial.value );
+	}
+	return result;
+}
+
+
+// func( i ) for every i in [first, last). Chunks assume the index walks an
+// array of 4-byte elements
+template<typename F>
+inline void ParallelFor( JobSystem& jobs, const uint32_t first, const uint32_t last, F&& func, const uint32_t grainSize = 0 )
+{
+	if ( last <= first ) {
+		return;
+	}
+	ParallelForChunks( jobs, last - first, ParallelAlignment<uint32_t>(), 0, grainSize, [&func, first]( const uint32_t begin, const uint32_t end ) {
+		for ( uint32_t i = first + begin; i < first + end; ++i ) {
+			func( i );
+		}
+	} );
+}
+
+
+// func( element ) for every element of data[ 0, count )
+template<class T, typename F>
+inline void ParallelFor( JobSystem& jobs, T* data, const uint32_t count, F&& func, const uint32_t grainSize = 0 )
+{
+	ParallelForChunks( jobs, count, ParallelAlignment<T>(), ParallelLead( data ), grainSize, [&func, data]( const uint32_t begin, const uint32_t end ) {
+		for ( uint32_t i = begin; i < end; ++i ) {
+			func( data[ i ] );
+		}
+	} );
+}
+
+
+// func( bitIndex ) for every set bit, chunked by words. The grain size counts words
+template<typename F>
+inline void ParallelForSetBits( JobSystem& jobs, const BitArray& bits, F&& func, const uint32_t grainSize = 0 )
+{
+	const uint64_t* words = bits.Words();
+	ParallelForChunks( jobs, bits.WordCount(), ParallelAlignment<uint64_t>(), ParallelLead( words ), grainSize, [&func, words]( const uint32_t begin, const uint32_t end ) {
+		for ( BitIterator it( words, end, begin ), last( words, end, end ); it != last; ++it ) {
+			func( *it );
+		}
+	} );
+}
+
+
+// acc = func( acc, i ) over [first, last), partials merged with combine( a, b )
+template<class T, typename F, typename Combine>
+inline T ParallelReduce( JobSystem& jobs, const uint32_t first, const uint32_t last, const T& identity, F&& func, Combine&& combine, const uint32_t grainSize = 0 )
+{
+	if ( last <= first ) {
+		return identity;
+	}
+	return ParallelReduceChunks( jobs, last - first, ParallelAlignment<uint32_t>(), 0, grainSize, identity, [&func, &identity, first]( const uint32_t begin, const uint32_t end ) {
+		T acc = identity;
+		for ( uint32_t i = first + begin; i < first + end; ++i ) {
+			acc = func( acc, i );
+		}
+		return acc;
+	}, combine );
+}
+
+
+// acc = func( acc, element ) over data[ 0, count )
+template<class T, class E, typename F, typename Combine>
+inline T ParallelReduce( JobSystem& jobs, const E* data, const uint32_t count, const T& identity, F&& func, Combine&& combine, const uint32_t grainSize = 0 )
+{
+	return ParallelReduceChunks( jobs, count, ParallelAlignment<E>(), ParallelLead( data ), grainSize, identity, [&func, &identity, data]( const uint32_t begin, const uint32_t end ) {
+		T acc = identity;
+		for ( uint32_t i = begin; i < end; ++i ) {
+			acc = func( acc, data[ i ] );
+		}
+		return acc;
+	}, combine );
+}
+
+
+// acc = func( acc, bitIndex ) over every set bit. The grain size counts words
+template<class T, typename F, typename Combine>
+inline T ParallelReduceSetBits( JobSystem& jobs, const BitArray& bits, const T& identity, F&& func, Combine&& combine, const uint32_t grainSize = 0 )
+{
+	const uint64_t* words = bits.Words();
+	return ParallelReduceChunks( jobs, bits.WordCount(), ParallelAlignment<uint64_t>(), ParallelLead( words ), grainSize, identity, [&func, &identity, words]( const uint32_t begin, const uint32_t end ) {
+		T acc = identity;
+		for ( BitIterator it( words, end, begin ), last( words, end, end ); it != last; ++it ) {
+			acc = func( acc, *it );
+		}
+		return acc;
+	}, combine );
+}
+}
@@ -0,0 +1,286 @@
+#include "radixSort.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <random>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace SysCore
+{
+static const uint32_t RadixBits = 8;
+static const uint32_t RadixBuckets = 1 << RadixBits;
+
+// Below this many elements per thread the thread start-up outweighs the work
+static const uint32_t MinParallelElements = 64 * 1024;
+
+static inline uint64_t KeyOf( const uint32_t key ) { return key; }
+static inline uint64_t KeyOf( const uint64_t key ) { return key; }
+static inline uint64_t KeyOf( const hdl_t& key ) { return key.Get(); }
+
+
+class SortBarrier
+{
+private:
+	std::atomic<uint32_t>	arrived;
+	std::atomic<uint32_t>	generation;
+	const uint32_t			total;
+public:
+	SortBarrier( const uint32_t _total ) : arrived( 0 ), generation( 0 ), total( _total ) {}
+
+	void Wait()
+	{
+		const uint32_t current = generation.load( std::memory_order_acquire );
+		if ( ( arrived.fetch_add( 1, std::memory_order_acq_rel ) + 1 ) == total )
+		{
+			arrived.store( 0, std::memory_order_relaxed );
+			generation.fetch_add( 1, std::memory_order_release );
+			return;
+		}
+		while ( generation.load( std::memory_order_acquire ) == current ) {
+			std::this_thread::yield();
+		}
+	}
+};
+
+
+template<class K, class V>
+struct radixSortJob_t
+{
+	K*					keys[ 2 ];
+	V*					values[ 2 ];	// nullptr when sorting keys only
+	uint32_t			count;
+	uint32_t			threadCount;
+	uint32_t			keyBits;
+	uint32_t*			histograms;		// threadCount * RadixBuckets
+	SortBarrier*		barrier;
+};
+
+
+template<class K, class V>
+static void RadixSortWorker( const radixSortJob_t<K, V>& job, const uint32_t threadIx )
+{
+	const uint32_t chunk = ( job.count + job.threadCount - 1 ) / job.threadCount;
+	const uint32_t begin = std::min( job.count, threadIx * chunk );
+	const uint32_t end = std::min( job.count, begin + chunk );
+
+	uint32_t* histogram = job.histograms + threadIx * RadixBuckets;
+	uint32_t offsets[ RadixBuckets ];
+	uint32_t src = 0;
+
+	for ( uint32_t shift = 0; shift < job.keyBits; shift += RadixBits )
+	{
+		const K* srcKeys = job.keys[ src ];
+		K* dstKeys = job.keys[ src ^ 1 ];
+
+		memset( histogram, 0, RadixBuckets * sizeof( uint32_t ) );
+		for ( uint32_t i = begin; i < end; ++i ) {
+			++histogram[ ( KeyOf( srcKeys[ i ] ) >> shift ) & ( RadixBuckets - 1 ) ];
+		}
+
+		if ( job.barrier != nullptr ) {
+			job.barrier->Wait();
+		}
+
+		// Each thread derives its own scatter offsets from every histogram:
+		// all smaller digits, then the same digit in earlier chunks
+		bool skipPass = false;
+		uint32_t base = 0;
+		for ( uint32_t digit = 0; digit < RadixBuckets; ++digit )
+		{
+			uint32_t digitTotal = 0;
+			uint32_t before = 0;
+			for ( uint32_t t = 0; t < job.threadCount; ++t )
+			{
+				const uint32_t digitCount = job.histograms[ t * RadixBuckets + digit ];
+				before += ( t < threadIx ) ? digitCount : 0;
+				digitTotal += digitCount;
+			}
+			skipPass |= ( digitTotal == job.count );
+			offsets[ digit ] = base + before;
+			base += digitTotal;
+		}
+
+		// Every key shares this digit, the order would not change
+		if ( skipPass == false )
+		{
+			if ( job.values[ 0 ] != nullptr )
+			{
+				const V* srcValues = job.values[ src ];
+				V* dstValues = job.values[ src ^ 1 ];
+				for ( uint32_t i = begin; i < end; ++i )
+				{
+					const uint32_t dst = offsets[ ( KeyOf( srcKeys[ i ] ) >> shift ) & ( RadixBuckets - 1 ) ]++;
+					dstKeys[ dst ] = srcKeys[ i ];
+					dstValues[ dst ] = srcValues[ i ];
+				}
+			}
+			else
+			{
+				for ( uint32_t i = begin; i < end; ++i ) {
+					dstKeys[ offsets[ ( KeyOf( srcKeys[ i ] ) >> shift ) & ( RadixBuckets - 1 ) ]++ ] = srcKeys[ i ];
+				}
+			}
+			src ^= 1;
+		}
+
+		if ( job.barrier != nullptr ) {
+			job.barrier->Wait();
+		}
+	}
+
+	if ( src != 0 )
+	{
+		std::copy( job.keys[ 1 ] + begin, job.keys[ 1 ] + end, job.keys[ 0 ] + begin );
+		if ( job.values[ 0 ] != nullptr ) {
+			std::copy( job.values[ 1 ] + begin, job.values[ 1 ] + end, job.values[ 0 ] + begin );
+		}
+	}
+}
+
+
+template<class K, class V>
+static void RadixSortImpl( K* keys, V* values, K* keyScratch, V* valueScratch, const uint32_t count, const uint32_t requestedThreads )
+{
+	if ( count <= 1 ) {
+		return;
+	}
+
+	const uint32_t maxUsefulThreads = std::max( 1u, count / MinParallelElements );
+	const uint32_t threadCount = std::max( 1u, std::min( requestedThreads, maxUsefulThreads ) );
+
+	std::vector<uint32_t> histograms( threadCount * RadixBuckets );
+	SortBarrier barrier( threadCount );
+
+	radixSortJob_t<K, V> job;
+	job.keys[ 0 ] = keys;
+	job.keys[ 1 ] = keyScratch;
+	job.values[ 0 ] = values;
+	job.values[ 1 ] = valueScratch;
+	job.count = count;
+	job.threadCount = threadCount;
+	job.keyBits = 8 * sizeof( K );
+	job.histograms = histograms.data();
+	job.barrier = ( threadCount > 1 ) ? &barrier : nullptr;
+
+	std::vector<std::thread> threads;
+	threads.reserve( threadCount - 1 );
+	for ( uint32_t threadIx = 1; threadIx < threadCount; ++threadIx ) {
+		threads.emplace_back( [&job, threadIx]() { RadixSortWorker( job, threadIx ); } );
+	}
+	RadixSortWorker( job, 0 );
+
+	for ( std::thread& thread : threads ) {
+		thread.join();
+	}
+}
+
+
+void RadixSort( uint32_t* keys, uint32_t* scratch, const uint32_t count, const uint32_t threadCount )
+{
+	RadixSortImpl<uint32_t, uint32_t>( keys, nullptr, scratch, nullptr, count, threadCount );
+}
+
+
+void RadixSort( uint64_t* keys, uint64_t* scratch, const uint32_t count, const uint32_t threadCount )
+{
+	RadixSortImpl<uint64_t, uint32_t>( keys, nullptr, scratch, nullptr, count, threadCount );
+}
+
+
+void RadixSort( hdl_t* handles, hdl_t* scratch, const uint32_t count, const uint32_t threadCount )
+{
+	RadixSortImpl<hdl_t, uint32_t>( handles, nullptr, scratch, nullptr, count, threadCount );
+}
+
+
+void RadixSortPairs( uint32_t* keys, uint32_t* values, uint32_t* keyScratch, uint32_t* valueScratch, const uint32_t count, const uint32_t threadCount )
+{
+	RadixSortImpl( keys, values, keyScratch, valueScratch, count, threadCount );
+}
+
+
+void RadixSortPairs( uint64_t* keys, uint32_t* values, uint64_t* keyScratch, uint32_t* valueScratch, const uint32_t count, const uint32_t threadCount )
+{
+	RadixSortImpl( keys, values, keyScratch, valueScratch, count, threadCount );
+}
+
+
+void TestRadixSort()
+{
+    std::mt19937_64 rng( 42 );
+
+    // --- Trivial sizes ---
+    {
+        uint32_t keys[ 1 ] = { 5 };
+        uint32_t scratch[ 1 ];
+        RadixSort( keys, scratch, 0 );
+        RadixSort( keys, scratch, 1 );
+        assert( keys[ 0 ] == 5 );
+    }
+
+    // --- 32 and 64-bit keys, serial and threaded ---
+    const uint32_t threadCounts[] = { 1, 4 };
+    for ( uint32_t threadIx = 0; threadIx < COUNTARRAY( threadCounts ); ++threadIx )
+    {
+        const uint32_t threads = threadCounts[ threadIx ];
+        const uint32_t count = 300000;
+
+        std::vector<uint32_t> keys32( count );
+        std::vector<uint32_t> scratch32( count );
+        for ( uint32_t& key : keys32 ) {
+            key = static_cast<uint32_t>( rng() );
+        }
+        std::vector<uint32_t> expected32 = keys32;
+        std::sort( expected32.begin(), expected32.end() );
+        RadixSort( keys32.data(), scratch32.data(), count, threads );
+        assert( keys32 == expected32 );
+
+        // Only low bits vary, so upper passes are skipped
+        std::vector<uint64_t> keys64( count );
+        std::vector<uint64_t> scratch64( count );
+        for ( uint64_t& key : keys64 ) {
+            key = ( 0xABCDull << 48 ) | ( rng() & 0xFFFFFF );
+        }
+        std::vector<uint64_t> expected64 = keys64;
+        std::sort( expected64.begin(), expected64.end() );
+        RadixSort( keys64.data(), scratch64.data(), count, threads );
+        assert( keys64 == expected64 );
+
+        // Pairs must be stable
+        std::vector<uint64_t> pairKeys( count );
+        std::vector<uint32_t> values( count );
+        std::vector<uint64_t> keyScratch( count );
+        std::vector<uint32_t> valueScratch( count );
+        for ( uint32_t i = 0; i < count; ++i )
+        {
+            pairKeys[ i ] = rng() % 1000;
+            values[ i ] = i;
+        }
+        RadixSortPairs( pairKeys.data(), values.data(), keyScratch.data(), valueScratch.data(), count, threads );
+        for ( uint32_t i = 1; i < count; ++i )
+        {
+            assert( pairKeys[ i - 1 ] <= pairKeys[ i ] );
+            assert( ( pairKeys[ i - 1 ] != pairKeys[ i ] ) || ( values[ i - 1 ] < values[ i ] ) );
+        }
+    }
+
+    // --- Handles ---
+    {
+        const uint32_t count = 1000;
+        std::vector<hdl_t> handles( count );
+        std::vector<hdl_t> scratch( count );
+        for ( hdl_t& handle : handles ) {
+            handle = hdl_t( rng() >> 1 );
+        }
+        handles[ 10 ] = INVALID_HDL;
+        RadixSort( handles.data(), scratch.data(), count );
+        for ( uint32_t i = 1; i < count; ++i ) {
+            assert( handles[ i - 1 ] <= handles[ i ] );
+        }
+        assert( !handles[ count - 1 ].IsValid() );
+    }
+}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common.h"
+#include "handle.h"
+
+namespace SysCore
+{
+void TestRadixSort();
+
+// LSD radix sorts, 8 bits per pass, stable. Scratch must hold count elements and is
+// clobbered; the sorted result always ends up back in the input array.
+// threadCount > 1 splits histogramming and scattering across threads for large inputs
+void RadixSort( uint32_t* keys, uint32_t* scratch, const uint32_t count, const uint32_t threadCount = 1 );
+void RadixSort( uint64_t* keys, uint64_t* scratch, const uint32_t count, const uint32_t threadCount = 1 );
+void RadixSort( hdl_t* handles, hdl_t* scratch, const uint32_t count, const uint32_t threadCount = 1 );
+
+// Sorts keys and reorders values alongside them
+void RadixSortPairs( uint32_t* keys, uint32_t* values, uint32_t* keyScratch, uint32_t* valueScratch, const uint32_t count, const uint32_t threadCount = 1 );
+void RadixSortPairs( uint64_t* keys, uint32_t* values, uint64_t* keyScratch, uint32_t* valueScratch, const uint32_t count, const uint32_t threadCount = 1 );
+}
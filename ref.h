@@ -4,7 +4,8 @@
 #include <assert.h>
 #include <cstdint>
 
-template<typename T>
+// Counts references to an object it does not own, only the count is freed
+template<typename T, typename RefCount = typename refCountPolicy_t<T>::type>
 class ref_t
 {
 public:
@@ -14,10 +15,10 @@ public:
 		this->instances = nullptr;
 	};
 
-	ref_t( const T* obj )
+	ref_t( T* obj )
 	{
 		this->object = obj;
-		this->instances = new refCount_t( 1 );
+		this->instances = new RefCount( 1 );
 	}
 
 	ref_t( const ref_t& handle )
@@ -36,27 +37,19 @@ public:
 
 	~ref_t()
 	{
-		if ( IsValid() )
-		{
-			instances->Release();
-			if ( instances->IsFree() )
-			{
-				delete instances;
-			}
-			instances = nullptr;
-		}
+		Drop();
 	}
 
 	ref_t& operator=( const ref_t& handle )
 	{
 		if ( this != &handle )
 		{
-			this->~ptr_t();
-			this->object = handle.object;
-			this->instances = handle.instances;
 			if ( handle.IsValid() ) {
-				this->instances->Add();
+				handle.instances->Add();
 			}
+			Drop();
+			this->object = handle.object;
+			this->instances = handle.instances;
 		}
 		return *this;
 	}
@@ -78,7 +71,7 @@ public:
 	}
 
 	void Release() {
-		this->~ptr_t();
+		Drop();
 	}
 
 	bool IsValid() const {
@@ -93,6 +86,18 @@ public:
 		return ( IsValid() && ( instances->IsFree() == false ) ) ? object : nullptr;
 	}
 private:
+	void Drop()
+	{
+		if ( IsValid() )
+		{
+			if ( instances->Release() == 0 ) {
+				delete instances;
+			}
+			instances = nullptr;
+			object = nullptr;
+		}
+	}
+
 	T*			object;
-	refCount_t*	instances;
-};
\ No newline at end of file
+	RefCount*	instances;
+};
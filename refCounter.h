@@ -1,12 +1,10 @@
 #pragma once
 
-
-
-#pragma once
-
 #include <assert.h>
+#include <atomic>
 #include <cstdint>
 
+// Plain count for objects owned by one thread at a time
 class refCount_t
 {
 public:
@@ -22,10 +20,80 @@ public:
 	inline int Release() {
 		return ( count > 0 ) ? --count : 0;
 	}
+	inline int ReleaseShared() {
+		return Release();
+	}
+	// Only takes a reference while the count is still alive
+	inline bool TryAdd() {
+		return ( Add() > 0 );
+	}
 	[[nodiscard]]
 	inline int IsFree() const {
 		return ( count <= 0 );
 	}
+	[[nodiscard]]
+	inline int Count() const {
+		return count;
+	}
 private:
 	int count; // Considered dead at 0
-};
\ No newline at end of file
+};
+
+// Count that may be shared across threads. Taking a reference only needs an
+// existing one, so increments are relaxed. Decrements are acq_rel so the thread
+// that frees the object sees every other owner's writes. A sole owner skips the
+// read-modify-write entirely: nobody else can add a reference without holding one
+class atomicRefCount_t
+{
+public:
+	atomicRefCount_t() = delete;
+
+	atomicRefCount_t( const int count ) : count( count ) {
+		assert( count > 0 );
+	}
+	inline int Add() {
+		return count.fetch_add( 1, std::memory_order_relaxed ) + 1;
+	}
+	inline int Release() {
+		if ( count.load( std::memory_order_acquire ) == 1 )
+		{
+			count.store( 0, std::memory_order_relaxed );
+			return 0;
+		}
+		return ReleaseShared();
+	}
+	// Release without the sole-owner shortcut, for counts that TryAdd() may be
+	// reviving from another thread at the same time
+	inline int ReleaseShared() {
+		return count.fetch_sub( 1, std::memory_order_acq_rel ) - 1;
+	}
+	inline bool TryAdd() {
+		int current = count.load( std::memory_order_relaxed );
+		while ( current > 0 )
+		{
+			if ( count.compare_exchange_weak( current, current + 1, std::memory_order_relaxed ) ) {
+				return true;
+			}
+		}
+		return false;
+	}
+	[[nodiscard]]
+	inline int IsFree() const {
+		return ( count.load( std::memory_order_acquire ) <= 0 );
+	}
+	[[nodiscard]]
+	inline int Count() const {
+		return count.load( std::memory_order_acquire );
+	}
+private:
+	std::atomic<int> count; // Considered dead at 0
+};
+
+// Default count for ptr_t<T>/ref_t<T>. Specialize for types that are shared
+// between threads:
+//   template<> struct refCountPolicy_t<Texture> { using type = atomicRefCount_t; };
+template<typename T>
+struct refCountPolicy_t
+{
+	using type = refCount_t;
+};
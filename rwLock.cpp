@@ -0,0 +1,281 @@
+#include "rwLock.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "timer.h"
+
+void RWLock::Sleep( const uint32_t observed )
+{
+	// Announce before the final check so an unlock either sees us or changes the word first
+	sleepers.fetch_add( 1, std::memory_order_seq_cst );
+	if ( state.load( std::memory_order_seq_cst ) == observed ) {
+		AtomicWait( &state, observed );
+	}
+	sleepers.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+
+void RWLock::ReadLockContended()
+{
+	SpinBackoff backoff;
+	for ( ;; )
+	{
+		uint32_t current = state.load( std::memory_order_relaxed );
+		while ( ( current & ( WRITE_LOCKED | WRITER_PENDING ) ) == 0 )
+		{
+			if ( state.compare_exchange_weak( current, current + 1, std::memory_order_acquire, std::memory_order_relaxed ) ) {
+				return;
+			}
+		}
+
+		if ( backoff.Spin() ) {
+			continue;
+		}
+		Sleep( current );
+	}
+}
+
+
+void RWLock::WriteLockContended()
+{
+	SpinBackoff backoff;
+	for ( ;; )
+	{
+		uint32_t current = state.load( std::memory_order_relaxed );
+		if ( ( current & ( READER_MASK | WRITE_LOCKED ) ) == 0 )
+		{
+			// Drops the pending bit, writers still waiting set it again
+			if ( state.compare_exchange_weak( current, WRITE_LOCKED, std::memory_order_acquire, std::memory_order_relaxed ) ) {
+				return;
+			}
+			continue;
+		}
+
+		// Hold off new readers
+		if ( ( current & WRITER_PENDING ) == 0 )
+		{
+			state.compare_exchange_weak( current, current | WRITER_PENDING, std::memory_order_relaxed );
+			continue;
+		}
+
+		if ( backoff.Spin() ) {
+			continue;
+		}
+		Sleep( current );
+	}
+}
+
+
+void TestRWLock()
+{
+    // --- Readers share, writers exclude ---
+    {
+        RWLock lock;
+        assert( lock.TryReadLock() );
+        assert( lock.TryReadLock() );
+        assert( !lock.TryWriteLock() );
+        lock.ReadUnlock();
+        lock.ReadUnlock();
+
+        assert( lock.TryWriteLock() );
+        assert( !lock.TryReadLock() );
+        assert( !lock.TryWriteLock() );
+        lock.WriteUnlock();
+
+        {
+            RWLockReadGuard guard( lock );
+            assert( !lock.TryWriteLock() );
+        }
+        {
+            RWLockWriteGuard guard( lock );
+            assert( !lock.TryReadLock() );
+        }
+        assert( lock.TryWriteLock() );
+        lock.WriteUnlock();
+    }
+
+    // --- A waiting writer blocks new readers ---
+    {
+        RWLock lock;
+        lock.ReadLock();
+        std::atomic<bool> written( false );
+        std::thread writer( [&]() {
+            RWLockWriteGuard guard( lock );
+            written.store( true );
+        } );
+
+        while ( lock.TryReadLock() )
+        {
+            lock.ReadUnlock();
+            std::this_thread::yield();
+        }
+        assert( !written.load() );
+        lock.ReadUnlock();
+        writer.join();
+        assert( written.load() );
+    }
+
+    // --- Readers always see a consistent pair ---
+    {
+        RWLock lock;
+        uint64_t a = 0;
+        uint64_t b = 0;
+        std::atomic<bool> done( false );
+
+        std::vector<std::thread> threads;
+        for ( uint32_t t = 0; t < 3; ++t )
+        {
+            threads.emplace_back( [&]() {
+                while ( !done.load( std::memory_order_relaxed ) )
+                {
+                    RWLockReadGuard guard( lock );
+                    assert( b == 2 * a );
+                }
+            } );
+        }
+        for ( uint32_t t = 0; t < 2; ++t )
+        {
+            threads.emplace_back( [&]() {
+                for ( uint32_t i = 0; i < 5000; ++i )
+                {
+                    RWLockWriteGuard guard( lock );
+                    ++a;
+                    b = 2 * a;
+                }
+            } );
+        }
+        threads[ 3 ].join();
+        threads[ 4 ].join();
+        done.store( true );
+        for ( uint32_t t = 0; t < 3; ++t ) {
+            threads[ t ].join();
+        }
+        assert( a == 10000 && b == 20000 );
+    }
+
+    // --- SeqLock snapshots are never torn ---
+    {
+        struct snapshot_t
+        {
+            uint64_t	frame;
+            uint32_t	pc;
+            uint32_t	check;
+            float		values[ 3 ];
+        };
+
+        SeqLock<snapshot_t> seqLock;
+        assert( seqLock.Load().frame == 0 );
+        std::atomic<bool> done( false );
+
+        std::vector<std::thread> readers;
+        for ( uint32_t t = 0; t < 3; ++t )
+        {
+            readers.emplace_back( [&]() {
+                uint64_t lastFrame = 0;
+                while ( !done.load( std::memory_order_relaxed ) )
+                {
+                    const snapshot_t snapshot = seqLock.Load();
+                    assert( snapshot.check == ( static_cast<uint32_t>( snapshot.frame ) ^ snapshot.pc ) );
+                    assert( snapshot.values[ 2 ] == static_cast<float>( snapshot.frame ) );
+                    assert( snapshot.frame >= lastFrame );
+                    lastFrame = snapshot.frame;
+                }
+            } );
+        }
+
+        for ( uint64_t frame = 1; frame <= 100000; ++frame )
+        {
+            const uint32_t pc = static_cast<uint32_t>( frame * 7919 );
+            const snapshot_t snapshot = { frame, pc, static_cast<uint32_t>( frame ) ^ pc, { 0.0f, 1.0f, static_cast<float>( frame ) } };
+            seqLock.Store( snapshot );
+        }
+        done.store( true );
+        for ( std::thread& reader : readers ) {
+            reader.join();
+        }
+        assert( seqLock.Load().frame == 100000 );
+        assert( seqLock.Version() == 200000 );
+    }
+}
+
+
+struct rwBenchState_t
+{
+    uint64_t values[ 4 ];
+};
+
+
+template<class ReadFn, class WriteFn>
+static uint64_t BenchmarkMix( const uint32_t threadCount, const uint32_t opsPerThread, const uint32_t writePercent, ReadFn read, WriteFn write )
+{
+    SysCore::Timer timer( "RWLock", SysCore::timerPrecision_t::MICROSECOND );
+    std::vector<std::thread> threads;
+    for ( uint32_t t = 0; t < threadCount; ++t )
+    {
+        threads.emplace_back( [&, t]() {
+            uint64_t sum = 0;
+            uint32_t rng = 0x9E3779B9u * ( t + 1 );
+            for ( uint32_t i = 0; i < opsPerThread; ++i )
+            {
+                rng ^= rng << 13;
+                rng ^= rng >> 17;
+                rng ^= rng << 5;
+                if ( ( rng % 100 ) < writePercent ) {
+                    write();
+                } else {
+                    sum += read();
+                }
+            }
+            volatile uint64_t sink = sum;
+            ( void )sink;
+        } );
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+    timer.Stop();
+    return std::max<uint64_t>( 1, timer.GetElapsed() );
+}
+
+
+void BenchmarkRWLock()
+{
+    const uint32_t threadCount = std::max( 4u, std::thread::hardware_concurrency() );
+    const uint32_t opsPerThread = 1 << 18;
+    const uint32_t writePercents[] = { 0, 1, 10, 50 };
+
+    for ( const uint32_t writePercent : writePercents )
+    {
+        rwBenchState_t state = {};
+
+        SpinLock spinLock;
+        const uint64_t spinUs = BenchmarkMix( threadCount, opsPerThread, writePercent,
+            [&]() { SpinLockGuard guard( spinLock ); return state.values[ 0 ] + state.values[ 3 ]; },
+            [&]() { SpinLockGuard guard( spinLock ); for ( uint64_t& value : state.values ) { ++value; } } );
+
+        RWLock rwLock;
+        const uint64_t rwUs = BenchmarkMix( threadCount, opsPerThread, writePercent,
+            [&]() { RWLockReadGuard guard( rwLock ); return state.values[ 0 ] + state.values[ 3 ]; },
+            [&]() { RWLockWriteGuard guard( rwLock ); for ( uint64_t& value : state.values ) { ++value; } } );
+
+        // SeqLock takes one writer, writers are serialized with a SpinLock
+        SeqLock<rwBenchState_t> seqLock;
+        SpinLock writerLock;
+        const uint64_t seqUs = BenchmarkMix( threadCount, opsPerThread, writePercent,
+            [&]() { const rwBenchState_t snapshot = seqLock.Load(); return snapshot.values[ 0 ] + snapshot.values[ 3 ]; },
+            [&]() {
+                SpinLockGuard guard( writerLock );
+                rwBenchState_t snapshot = seqLock.Load();
+                for ( uint64_t& value : snapshot.values ) { ++value; }
+                seqLock.Store( snapshot );
+            } );
+
+        const uint64_t totalOps = static_cast<uint64_t>( threadCount ) * opsPerThread;
+        std::cout << threadCount << " threads, " << writePercent << "% writes: SpinLock " << ( totalOps / spinUs ) << "M ops/s, RWLock "
+            << ( totalOps / rwUs ) << "M ops/s, SeqLock " << ( totalOps / seqUs ) << "M ops/s" << std::endl;
+    }
+}
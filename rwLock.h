@@ -0,0 +1,257 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string.h>
+#include <type_traits>
+
+#include "common.h"
+#include "spinlock.h"
+
+void TestRWLock();
+void BenchmarkRWLock();
+
+// Reader-writer lock with writer preference. One word holds the reader count,
+// a write-locked bit and a writer-pending bit; a pending writer stops new readers
+// from entering so a steady stream of readers can't starve it. Waiters spin with
+// backoff like SpinLock, then sleep on the word. Unlocks only make the wake
+// call when someone is actually asleep. Under SYSCORE_LOCK_PROFILING both
+// sides count acquisitions and waits against the name, hold time is write-only.
+class RWLock
+{
+public:
+	RWLock( const char* name = nullptr ) {
+		state.store( 0, std::memory_order_relaxed );
+		sleepers.store( 0, std::memory_order_relaxed );
+#ifdef SYSCORE_LOCK_PROFILING
+		profileId = LockProfileRegister( name );
+		holdStart = 0;
+#else
+		(void)name;
+#endif
+	}
+
+	RWLock( const RWLock& ) = delete;
+	RWLock& operator=( const RWLock& ) = delete;
+
+	[[nodiscard]]
+	bool TryReadLock() {
+#ifdef SYSCORE_LOCK_PROFILING
+		if ( TryAcquireRead() == false ) {
+			return false;
+		}
+		LockProfileAcquired( profileId, false, 0 );
+		return true;
+#else
+		return TryAcquireRead();
+#endif
+	}
+
+	void ReadLock() {
+#ifdef SYSCORE_LOCK_PROFILING
+		const bool contended = ( TryAcquireRead() == false );
+		const uint64_t waitStart = contended ? LockProfileNow() : 0;
+		if ( contended ) {
+			ReadLockContended();
+		}
+		LockProfileAcquired( profileId, contended, contended ? ( LockProfileNow() - waitStart ) : 0 );
+#else
+		if ( TryAcquireRead() == false ) {
+			ReadLockContended();
+		}
+#endif
+	}
+
+	void ReadUnlock() {
+		const uint32_t previous = state.fetch_sub( 1, std::memory_order_seq_cst );
+		// Last reader out lets a pending writer in
+		if ( ( ( previous & READER_MASK ) == 1 ) && ( ( previous & WRITER_PENDING ) != 0 ) ) {
+			WakeSleepers();
+		}
+	}
+
+	[[nodiscard]]
+	bool TryWriteLock() {
+#ifdef SYSCORE_LOCK_PROFILING
+		if ( TryAcquireWrite() == false ) {
+			return false;
+		}
+		LockProfileAcquired( profileId, false, 0 );
+		holdStart = LockProfileNow();
+		return true;
+#else
+		return TryAcquireWrite();
+#endif
+	}
+
+	void WriteLock() {
+#ifdef SYSCORE_LOCK_PROFILING
+		const bool contended = ( TryAcquireWrite() == false );
+		const uint64_t waitStart = contended ? LockProfileNow() : 0;
+		if ( contended ) {
+			WriteLockContended();
+		}
+		holdStart = LockProfileNow();
+		LockProfileAcquired( profileId, contended, contended ? ( holdStart - waitStart ) : 0 );
+#else
+		if ( TryAcquireWrite() == false ) {
+			WriteLockContended();
+		}
+#endif
+	}
+
+	void WriteUnlock() {
+#ifdef SYSCORE_LOCK_PROFILING
+		LockProfileReleased( profileId, LockProfileNow() - holdStart );
+#endif
+		state.fetch_and( ~WRITE_LOCKED, std::memory_order_seq_cst );
+		WakeSleepers();
+	}
+private:
+	static const uint32_t READER_MASK = ( 1u << 30 ) - 1;
+	static const uint32_t WRITE_LOCKED = 1u << 30;
+	static const uint32_t WRITER_PENDING = 1u << 31;
+
+	inline bool TryAcquireRead() {
+		uint32_t current = state.load( std::memory_order_relaxed );
+		return ( ( current & ( WRITE_LOCKED | WRITER_PENDING ) ) == 0 ) &&
+			state.compare_exchange_strong( current, current + 1, std::memory_order_acquire, std::memory_order_relaxed );
+	}
+
+	inline bool TryAcquireWrite() {
+		uint32_t current = state.load( std::memory_order_relaxed );
+		return ( ( current & ( READER_MASK | WRITE_LOCKED ) ) == 0 ) &&
+			state.compare_exchange_strong( current, WRITE_LOCKED, std::memory_order_acquire, std::memory_order_relaxed );
+	}
+
+	void ReadLockContended();
+	void WriteLockContended();
+	void Sleep( const uint32_t observed );
+
+	inline void WakeSleepers() {
+		if ( sleepers.load( std::memory_order_seq_cst ) != 0 ) {
+			AtomicWakeAll( &state );
+		}
+	}
+
+	std::atomic<uint32_t> state;
+	std::atomic<uint32_t> sleepers;
+#ifdef SYSCORE_LOCK_PROFILING
+	uint32_t profileId;
+	uint64_t holdStart;		// Only touched by the writer holding the lock
+#endif
+};
+
+class RWLockReadGuard
+{
+public:
+	RWLockReadGuard( RWLock& _lock ) : lock( _lock ) {
+		lock.ReadLock();
+	}
+
+	~RWLockReadGuard() {
+		lock.ReadUnlock();
+	}
+
+	RWLockReadGuard( const RWLockReadGuard& ) = delete;
+	RWLockReadGuard& operator=( const RWLockReadGuard& ) = delete;
+private:
+	RWLock& lock;
+};
+
+class RWLockWriteGuard
+{
+public:
+	RWLockWriteGuard( RWLock& _lock ) : lock( _lock ) {
+		lock.WriteLock();
+	}
+
+	~RWLockWriteGuard() {
+		lock.WriteUnlock();
+	}
+
+	RWLockWriteGuard( const RWLockWriteGuard& ) = delete;
+	RWLockWriteGuard& operator=( const RWLockWriteGuard& ) = delete;
+private:
+	RWLock& lock;
+};
+
+// Sequence lock for small trivially copyable values. The writer makes the
+// sequence odd, writes, then makes it even again; readers copy the value and
+// retry if the sequence was odd or moved. Readers never write shared memory, so
+// they don't contend with each other at all. One writer at a time, serialize
+// writers externally if there are several.
+template<class T>
+class SeqLock
+{
+private:
+	static_assert( std::is_trivially_copyable_v<T>, "SeqLock values must be trivially copyable" );
+
+	static constexpr uint32_t WordCount = static_cast<uint32_t>( ( sizeof( T ) + sizeof( uint64_t ) - 1 ) / sizeof( uint64_t ) );
+
+	// The value is kept as relaxed atomic words so torn reads are well defined
+	alignas( CACHE_LINE_SIZE ) std::atomic<uint32_t>	sequence;
+	std::atomic<uint64_t>								words[ WordCount ];
+
+public:
+	SeqLock() : SeqLock( T{} )
+	{}
+
+	SeqLock( const T& value )
+	{
+		sequence.store( 0, std::memory_order_relaxed );
+		uint64_t buffer[ WordCount ] = {};
+		memcpy( buffer, &value, sizeof( T ) );
+		for ( uint32_t i = 0; i < WordCount; ++i ) {
+			words[ i ].store( buffer[ i ], std::memory_order_relaxed );
+		}
+	}
+
+	SeqLock( const SeqLock& ) = delete;
+	SeqLock& operator=( const SeqLock& ) = delete;
+
+	inline void Store( const T& value )
+	{
+		uint64_t buffer[ WordCount ] = {};
+		memcpy( buffer, &value, sizeof( T ) );
+
+		const uint32_t current = sequence.load( std::memory_order_relaxed );
+		sequence.store( current + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		for ( uint32_t i = 0; i < WordCount; ++i ) {
+			words[ i ].store( buffer[ i ], std::memory_order_relaxed );
+		}
+		sequence.store( current + 2, std::memory_order_release );
+	}
+
+	inline T Load() const
+	{
+		uint64_t buffer[ WordCount ];
+		for ( ;; )
+		{
+			const uint32_t before = sequence.load( std::memory_order_acquire );
+			if ( ( before & 1 ) != 0 )
+			{
+				CpuPause();
+				continue;
+			}
+			for ( uint32_t i = 0; i < WordCount; ++i ) {
+				buffer[ i ] = words[ i ].load( std::memory_order_relaxed );
+			}
+			std::atomic_thread_fence( std::memory_order_acquire );
+			if ( sequence.load( std::memory_order_relaxed ) == before ) {
+				break;
+			}
+		}
+
+		T value;
+		memcpy( &value, buffer, sizeof( T ) );
+		return value;
+	}
+
+	// Bumped by every Store(), lets readers skip work when nothing changed
+	inline uint32_t Version() const
+	{
+		return sequence.load( std::memory_order_acquire );
+	}
+};
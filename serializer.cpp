@@ -86,8 +86,10 @@ bool Serializer::Grow( const uint32_t sizeInBytes )
 	m_byteCount += sizeInBytes;
 
 	uint8_t* newBytes = new uint8_t[ m_byteCount ];
+	MEM_TRACK_ALLOC( SysCore::memTag_t::SERIALIZER, m_byteCount );
 	if( m_bytes != nullptr ) {
 		memcpy( newBytes, m_bytes, oldCount );
+		MEM_TRACK_FREE( SysCore::memTag_t::SERIALIZER, std::max( oldCount, 1u ) );
 		delete[] m_bytes;
 	}
 	memset( newBytes + oldCount, 0, sizeInBytes );
@@ -2,6 +2,8 @@
 #include <string>
 #include <algorithm>
 
+#include "memTracker.h"
+
 #define DBG_SERIALIZER 0
 
 enum class serializeMode_t
@@ -189,11 +191,8 @@ public:
 	Serializer( const uint32_t _sizeInBytes, serializeMode_t _mode )
 	{
 		m_byteCount = std::min( MaxByteCount, _sizeInBytes );
-		if( m_byteCount > 0 ) {
-			m_bytes = new uint8_t[ _sizeInBytes ];
-		} else {
-			m_bytes = new uint8_t[ 1 ];
-		}
+		m_bytes = new uint8_t[ std::max( m_byteCount, 1u ) ];
+		MEM_TRACK_ALLOC( SysCore::memTag_t::SERIALIZER, std::max( m_byteCount, 1u ) );
 		m_mode = _mode;
 		m_endian = serializeEndian_t::LITTLE;
 		Clear();
@@ -201,7 +200,9 @@ public:
 
 	~Serializer()
 	{
-		if ( m_bytes != nullptr ) {
+		if ( m_bytes != nullptr )
+		{
+			MEM_TRACK_FREE( SysCore::memTag_t::SERIALIZER, std::max( m_byteCount, 1u ) );
 			delete[] m_bytes;
 		}
 		m_byteCount = 0;
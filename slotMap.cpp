@@ -0,0 +1,72 @@
+#include "slotMap.h"
+
+#include <string>
+
+namespace SysCore
+{
+void TestSlotMap()
+{
+    // --- Insert and lookup ---
+    {
+        SlotMap<std::string> map;
+        const hdl_t a = map.Insert( "a" );
+        const hdl_t b = map.Emplace( 3, 'b' );
+        assert( a.IsValid() && b.IsValid() );
+        assert( a != b );
+        assert( map.Count() == 2 );
+        assert( *map.Get( a ) == "a" );
+        assert( *map.Get( b ) == "bbb" );
+        assert( map.Get( INVALID_HDL ) == nullptr );
+        assert( !map.Contains( INVALID_HDL ) );
+    }
+
+    // --- Erase keeps storage packed and rejects stale handles ---
+    {
+        SlotMap<uint32_t> map;
+        hdl_t handles[ 8 ];
+        for ( uint32_t i = 0; i < 8; ++i ) {
+            handles[ i ] = map.Insert( i );
+        }
+
+        assert( map.Erase( handles[ 2 ] ) );
+        assert( !map.Erase( handles[ 2 ] ) );
+        assert( !map.Contains( handles[ 2 ] ) );
+        assert( map.Get( handles[ 2 ] ) == nullptr );
+        assert( map.Count() == 7 );
+
+        // Last value moved into the hole, its handle still resolves
+        assert( *map.Get( handles[ 7 ] ) == 7 );
+        assert( map.Ptr()[ 2 ] == 7 );
+
+        // Reused slot gets a new generation
+        const hdl_t reused = map.Insert( 100 );
+        assert( ( reused.Get() & 0xFFFFFFFF ) == ( handles[ 2 ].Get() & 0xFFFFFFFF ) );
+        assert( reused != handles[ 2 ] );
+        assert( map.Get( handles[ 2 ] ) == nullptr );
+        assert( *map.Get( reused ) == 100 );
+
+        uint32_t sum = 0;
+        for ( const uint32_t value : map ) {
+            sum += value;
+        }
+        assert( sum == ( 0 + 1 + 3 + 4 + 5 + 6 + 7 + 100 ) );
+
+        for ( uint32_t i = 0; i < map.Count(); ++i ) {
+            assert( *map.Get( map.HandleAt( i ) ) == map.Ptr()[ i ] );
+        }
+    }
+
+    // --- Reset invalidates everything ---
+    {
+        SlotMap<uint32_t> map;
+        const hdl_t a = map.Insert( 1 );
+        const hdl_t b = map.Insert( 2 );
+        map.Reset();
+        assert( map.Count() == 0 );
+        assert( !map.Contains( a ) && !map.Contains( b ) );
+        const hdl_t c = map.Insert( 3 );
+        assert( c != a && c != b );
+        assert( *map.Get( c ) == 3 );
+    }
+}
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "handle.h"
+
+namespace SysCore
+{
+void TestSlotMap();
+
+// Values stored densely with stable handles. A handle packs a slot index (low 32 bits)
+// and that slot's generation (high 32 bits). Erasing bumps the generation, so handles
+// to a freed or reused slot fail the lookup instead of aliasing the new value
+template<class T>
+class SlotMap
+{
+private:
+	static constexpr uint32_t InvalidIndex = ~0u;
+	static constexpr uint32_t MaxGeneration = ~0u - 1;
+
+	struct slot_t
+	{
+		uint32_t	index;		// Dense index when live, next free slot otherwise
+		uint32_t	generation;
+	};
+
+	std::vector<T>			values;
+	std::vector<uint32_t>	denseToSlot;
+	std::vector<slot_t>		slots;
+	uint32_t				freeHead;
+
+	static inline hdl_t MakeHandle( const uint32_t slotIx, const uint32_t generation )
+	{
+		return hdl_t( ( static_cast<uint64_t>( generation ) << 32 ) | slotIx );
+	}
+
+	inline const slot_t* Lookup( const hdl_t& handle ) const
+	{
+		const uint64_t value = handle.Get();
+		const uint32_t slotIx = static_cast<uint32_t>( value & 0xFFFFFFFF );
+		const uint32_t generation = static_cast<uint32_t>( value >> 32 );
+
+		if ( ( slotIx >= slots.size() ) || ( slots[ slotIx ].generation != generation ) ) {
+			return nullptr;
+		}
+		return &slots[ slotIx ];
+	}
+
+public:
+
+	SlotMap() : freeHead( InvalidIndex )
+	{}
+
+	inline void Reserve( const uint32_t capacity )
+	{
+		values.reserve( capacity );
+		denseToSlot.reserve( capacity );
+		slots.reserve( capacity );
+	}
+
+	template<typename... Args>
+	inline hdl_t Emplace( Args&&... args )
+	{
+		uint32_t slotIx = freeHead;
+		if ( slotIx != InvalidIndex ) {
+			freeHead = slots[ slotIx ].index;
+		}
+		else
+		{
+			slotIx = static_cast<uint32_t>( slots.size() );
+			slots.push_back( slot_t{ InvalidIndex, 0 } );
+		}
+
+		slot_t& slot = slots[ slotIx ];
+		slot.index = static_cast<uint32_t>( values.size() );
+		values.emplace_back( std::forward<Args>( args )... );
+		denseToSlot.push_back( slotIx );
+
+		return MakeHandle( slotIx, slot.generation );
+	}
+
+	inline hdl_t Insert( const T& value )
+	{
+		return Emplace( value );
+	}
+
+	inline hdl_t Insert( T&& value )
+	{
+		return Emplace( std::move( value ) );
+	}
+
+	// Swaps the last value into the hole so storage stays packed
+	inline bool Erase( const hdl_t& handle )
+	{
+		const slot_t* found = Lookup( handle );
+		if ( found == nullptr ) {
+			return false;
+		}
+
+		const uint32_t slotIx = static_cast<uint32_t>( found - slots.data() );
+		slot_t& slot = slots[ slotIx ];
+		const uint32_t denseIx = slot.index;
+		const uint32_t lastIx = static_cast<uint32_t>( values.size() - 1 );
+
+		if ( denseIx != lastIx )
+		{
+			values[ denseIx ] = std::move( values[ lastIx ] );
+			denseToSlot[ denseIx ] = denseToSlot[ lastIx ];
+			slots[ denseToSlot[ denseIx ] ].index = denseIx;
+		}
+		values.pop_back();
+		denseToSlot.pop_back();
+
+		// Retire slots whose generation would run out rather than risk an alias
+		++slot.generation;
+		if ( slot.generation <= MaxGeneration )
+		{
+			slot.index = freeHead;
+			freeHead = slotIx;
+		}
+		return true;
+	}
+
+	inline T* Get( const hdl_t& handle )
+	{
+		const slot_t* slot = Lookup( handle );
+		return ( slot != nullptr ) ? &values[ slot->index ] : nullptr;
+	}
+
+	inline const T* Get( const hdl_t& handle ) const
+	{
+		const slot_t* slot = Lookup( handle );
+		return ( slot != nullptr ) ? &values[ slot->index ] : nullptr;
+	}
+
+	inline bool Contains( const hdl_t& handle ) const
+	{
+		return ( Lookup( handle ) != nullptr );
+	}
+
+	// Handle of the value at a dense index, for use while iterating
+	inline hdl_t HandleAt( const uint32_t denseIx ) const
+	{
+		assert( denseIx < values.size() );
+		const uint32_t slotIx = denseToSlot[ denseIx ];
+		return MakeHandle( slotIx, slots[ slotIx ].generation );
+	}
+
+	inline void Reset()
+	{
+		for ( uint32_t denseIx = 0; denseIx < static_cast<uint32_t>( denseToSlot.size() ); ++denseIx )
+		{
+			const uint32_t slotIx = denseToSlot[ denseIx ];
+			slot_t& slot = slots[ slotIx ];
+			++slot.generation;
+			if ( slot.generation <= MaxGeneration )
+			{
+				slot.index = freeHead;
+				freeHead = slotIx;
+			}
+		}
+		values.clear();
+		denseToSlot.clear();
+	}
+
+	inline T* Ptr()
+	{
+		return values.data();
+	}
+
+	inline const T* Ptr() const
+	{
+		return values.data();
+	}
+
+	inline uint32_t Count() const
+	{
+		return static_cast<uint32_t>( values.size() );
+	}
+
+	inline typename std::vector<T>::iterator begin()
+	{
+		return values.begin();
+	}
+
+	inline typename std::vector<T>::iterator end()
+	{
+		return values.end();
+	}
+
+	inline typename std::vector<T>::const_iterator begin() const
+	{
+		return values.begin();
+	}
+
+	inline typename std::vector<T>::const_iterator end() const
+	{
+		return values.end();
+	}
+};
+}
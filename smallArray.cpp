@@ -0,0 +1,203 @@
+#include "smallArray.h"
+
+#include <vector>
+
+static int smallArrayTestLive = 0;
+
+struct smallArrayTestObject_t
+{
+    std::vector<int> values;
+
+    smallArrayTestObject_t() { ++smallArrayTestLive; }
+    smallArrayTestObject_t( const int value ) : values( 1, value ) { ++smallArrayTestLive; }
+    smallArrayTestObject_t( const smallArrayTestObject_t& rhs ) : values( rhs.values ) { ++smallArrayTestLive; }
+    smallArrayTestObject_t( smallArrayTestObject_t&& rhs ) noexcept : values( std::move( rhs.values ) ) { ++smallArrayTestLive; }
+    ~smallArrayTestObject_t() { --smallArrayTestLive; }
+
+    smallArrayTestObject_t& operator=( const smallArrayTestObject_t& ) = default;
+    smallArrayTestObject_t& operator=( smallArrayTestObject_t&& ) = default;
+
+    inline int Value() const
+    {
+        return values.empty() ? -1 : values[ 0 ];
+    }
+};
+
+
+void TestSmallArray()
+{
+    using testArray_t = SmallArray<smallArrayTestObject_t, 4>;
+
+    // The trap element lives for the whole run, count from after it exists
+    {
+        testArray_t empty;
+        empty.Resize( 0 );
+    }
+    const int baseLive = smallArrayTestLive;
+
+    auto fill = []( testArray_t& a, const int elementCount ) {
+        for ( int i = 0; i < elementCount; ++i ) {
+            a.Emplace( i );
+        }
+    };
+
+    auto holds = []( const testArray_t& a, const int elementCount ) {
+        if ( a.Count() != static_cast<uint32_t>( elementCount ) ) {
+            return false;
+        }
+        for ( int i = 0; i < elementCount; ++i )
+        {
+            if ( a[ i ].Value() != i ) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // --- Inline storage spills to the heap ---
+    {
+        testArray_t a;
+        fill( a, 4 );
+        assert( a.IsInline() );
+        assert( a.Capacity() == 4 );
+        assert( smallArrayTestLive == baseLive + 4 );
+
+        a.Append( smallArrayTestObject_t( 4 ) );
+        assert( !a.IsInline() );
+        assert( a.Capacity() >= 5 );
+        assert( holds( a, 5 ) );
+        assert( smallArrayTestLive == baseLive + 5 );
+    }
+    assert( smallArrayTestLive == baseLive );
+
+    // --- Growth is geometric ---
+    {
+        testArray_t a;
+        uint32_t lastCapacity = a.Capacity();
+        uint32_t reallocations = 0;
+        for ( int i = 0; i < 1000; ++i )
+        {
+            a.Emplace( i );
+            if ( a.Capacity() != lastCapacity )
+            {
+                assert( a.Capacity() == 2 * lastCapacity );
+                lastCapacity = a.Capacity();
+                ++reallocations;
+            }
+        }
+        assert( reallocations == 8 );
+        assert( holds( a, 1000 ) );
+        assert( smallArrayTestLive == baseLive + 1000 );
+
+        a.Resize( 2000 );
+        assert( a.Capacity() >= 2000 );
+        assert( a[ 1999 ].Value() == -1 );
+        assert( smallArrayTestLive == baseLive + 2000 );
+    }
+    assert( smallArrayTestLive == baseLive );
+
+    // --- ShrinkToFit ---
+    {
+        testArray_t a;
+        fill( a, 20 );
+        a.Shrink( 10 );
+        assert( smallArrayTestLive == baseLive + 10 );
+        a.ShrinkToFit();
+        assert( !a.IsInline() );
+        assert( a.Capacity() == 10 );
+        assert( holds( a, 10 ) );
+
+        // Back into inline storage once the elements fit
+        a.Shrink( 7 );
+        a.ShrinkToFit();
+        assert( a.IsInline() );
+        assert( a.Capacity() == 4 );
+        assert( holds( a, 3 ) );
+        assert( smallArrayTestLive == baseLive + 3 );
+
+        // Emptying returns the trap, never a destroyed slot
+        assert( &a.Resize( 0 ) != a.Ptr() );
+        assert( smallArrayTestLive == baseLive );
+    }
+    assert( smallArrayTestLive == baseLive );
+
+    // --- Copy and move, inline and heap ---
+    for ( const int elementCount : { 3, 12 } )
+    {
+        const bool inlined = ( elementCount <= 4 );
+        testArray_t a;
+        fill( a, elementCount );
+
+        testArray_t copy( a );
+        assert( copy.IsInline() == inlined );
+        assert( holds( copy, elementCount ) );
+        assert( smallArrayTestLive == baseLive + 2 * elementCount );
+
+        const smallArrayTestObject_t* heap = copy.Ptr();
+        testArray_t moved( std::move( copy ) );
+        assert( holds( moved, elementCount ) );
+        assert( copy.Count() == 0 );
+        assert( copy.IsInline() );
+        assert( ( moved.Ptr() == heap ) == !inlined );
+        assert( smallArrayTestLive == baseLive + 2 * elementCount );
+
+        // Assign over both an inline and a heap target
+        testArray_t small;
+        fill( small, 2 );
+        testArray_t large;
+        fill( large, 9 );
+        small = a;
+        large = a;
+        assert( holds( small, elementCount ) && holds( large, elementCount ) );
+        assert( smallArrayTestLive == baseLive + 4 * elementCount );
+
+        small = std::move( moved );
+        assert( holds( small, elementCount ) );
+        assert( moved.Count() == 0 );
+        assert( small.IsInline() == inlined );
+        large = std::move( small );
+        assert( holds( large, elementCount ) );
+        assert( small.Count() == 0 );
+        assert( smallArrayTestLive == baseLive + 2 * elementCount );
+
+        const testArray_t& self = large;
+        large = self;
+        assert( holds( large, elementCount ) );
+        assert( smallArrayTestLive == baseLive + 2 * elementCount );
+    }
+    assert( smallArrayTestLive == baseLive );
+
+    // --- Appending an element of the array to itself while it grows ---
+    {
+        testArray_t a;
+        fill( a, 4 );
+
+        // Inline to heap, then heap to a larger heap
+        a.Append( a[ 0 ] );
+        assert( !a.IsInline() );
+        assert( a[ 4 ].Value() == 0 );
+        while ( a.Count() < a.Capacity() ) {
+            a.Emplace( 1 );
+        }
+        a.Append( a[ 1 ] );
+        assert( a[ a.Count() - 1 ].Value() == 1 );
+        while ( a.Count() < a.Capacity() ) {
+            a.Emplace( 2 );
+        }
+        a.Emplace( a[ 2 ] );
+        assert( a[ a.Count() - 1 ].Value() == 2 );
+
+        // A range of the array's own elements
+        while ( a.Count() < a.Capacity() ) {
+            a.Emplace( 3 );
+        }
+        const uint32_t full = a.Count();
+        a.Append( a.Ptr(), full );
+        assert( a.Count() == 2 * full );
+        for ( uint32_t i = 0; i < full; ++i ) {
+            assert( a[ full + i ].Value() == a[ i ].Value() );
+        }
+        assert( smallArrayTestLive == baseLive + static_cast<int>( a.Count() ) );
+    }
+    assert( smallArrayTestLive == baseLive );
+}
@@ -0,0 +1,362 @@
+#pragma once
+#include <assert.h>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+#include "memTracker.h"
+
+void TestSmallArray();
+
+// Array with N elements of inline storage that moves to the heap, growing
+// geometrically, once it runs out. Shares the Array<T, N> API but never truncates
+template<class T, uint32_t N, class Allocator = SysCore::TaggedAllocator<T, SysCore::memTag_t::CONTAINER>>
+class SmallArray
+{
+private:
+	using AllocTraits = std::allocator_traits<Allocator>;
+
+	static constexpr bool IsTrivial = std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>;
+
+	static_assert( N > 0, "SmallArray requires inline capacity, use std::vector otherwise" );
+
+	alignas( T ) uint8_t	inlineStorage[ N * sizeof( T ) ];
+	T*						elements;
+	uint32_t				count;
+	uint32_t				capacity;
+	Allocator				allocator;
+
+	// Start of the inline buffer. Elements are constructed into it later, so there
+	// is no live T to launder here
+	inline T* InlinePtr()
+	{
+		return reinterpret_cast<T*>( inlineStorage );
+	}
+
+	static inline T& Trap()
+	{
+		static T trap;
+		return trap;
+	}
+
+	static inline void DestroyRange( T* first, const uint32_t elementCount )
+	{
+		if constexpr ( std::is_trivially_destructible_v<T> == false )
+		{
+			for ( uint32_t i = 0; i < elementCount; ++i ) {
+				first[ i ].~T();
+			}
+		}
+	}
+
+	// Moves elements into uninitialized memory and destroys the source
+	static inline void Relocate( T* dst, T* src, const uint32_t elementCount )
+	{
+		if constexpr ( IsTrivial ) {
+			memcpy( dst, src, elementCount * sizeof( T ) );
+		} else {
+			for ( uint32_t i = 0; i < elementCount; ++i )
+			{
+				new ( dst + i ) T( std::move( src[ i ] ) );
+				src[ i ].~T();
+			}
+		}
+	}
+
+	inline uint32_t NextCapacity( const uint32_t required ) const
+	{
+		const uint32_t doubled = ( capacity > ( UINT32_MAX / 2 ) ) ? UINT32_MAX : ( 2 * capacity );
+		return ( doubled > required ) ? doubled : required;
+	}
+
+	inline void ReleaseHeap()
+	{
+		if ( IsInline() == false ) {
+			AllocTraits::deallocate( allocator, elements, capacity );
+		}
+		elements = InlinePtr();
+		capacity = N;
+	}
+
+	inline void MoveTo( T* newElements, const uint32_t newCapacity )
+	{
+		Relocate( newElements, elements, count );
+		ReleaseHeap();
+		elements = newElements;
+		capacity = newCapacity;
+	}
+
+	inline void CopyFrom( const SmallArray& rhs )
+	{
+		Reserve( rhs.count );
+		if constexpr ( IsTrivial ) {
+			memcpy( elements, rhs.elements, rhs.count * sizeof( T ) );
+		} else {
+			for ( uint32_t i = 0; i < rhs.count; ++i ) {
+				new ( elements + i ) T( rhs.elements[ i ] );
+			}
+		}
+		count = rhs.count;
+	}
+
+	inline void MoveFrom( SmallArray& rhs )
+	{
+		if ( rhs.IsInline() )
+		{
+			Relocate( elements, rhs.elements, rhs.count );
+			count = rhs.count;
+			rhs.count = 0;
+			return;
+		}
+
+		// Steal the heap buffer
+		elements = rhs.elements;
+		capacity = rhs.capacity;
+		count = rhs.count;
+		rhs.elements = rhs.InlinePtr();
+		rhs.capacity = N;
+		rhs.count = 0;
+	}
+
+	// Empty arrays have no last element, hand back the trap rather than unconstructed storage
+	inline T& Last()
+	{
+		return ( count == 0 ) ? Trap() : elements[ count - 1 ];
+	}
+
+public:
+
+	SmallArray( const Allocator& _allocator = Allocator() )
+		: elements( InlinePtr() ), count( 0 ), capacity( N ), allocator( _allocator )
+	{}
+
+	SmallArray( const SmallArray& rhs )
+		: elements( InlinePtr() ), count( 0 ), capacity( N ), allocator( AllocTraits::select_on_container_copy_construction( rhs.allocator ) )
+	{
+		CopyFrom( rhs );
+	}
+
+	SmallArray( SmallArray&& rhs ) noexcept
+		: elements( InlinePtr() ), count( 0 ), capacity( N ), allocator( std::move( rhs.allocator ) )
+	{
+		MoveFrom( rhs );
+	}
+
+	~SmallArray()
+	{
+		Reset();
+		ReleaseHeap();
+	}
+
+	SmallArray& operator=( const SmallArray& rhs )
+	{
+		if ( this != &rhs )
+		{
+			Reset();
+			CopyFrom( rhs );
+		}
+		return *this;
+	}
+
+	SmallArray& operator=( SmallArray&& rhs ) noexcept
+	{
+		if ( this != &rhs )
+		{
+			Reset();
+			ReleaseHeap();
+			if ( allocator == rhs.allocator )
+			{
+				MoveFrom( rhs );
+			}
+			else
+			{
+				// Buffers from another allocator can't be adopted
+				Reserve( rhs.count );
+				Relocate( elements, rhs.elements, rhs.count );
+				count = rhs.count;
+				rhs.count = 0;
+			}
+		}
+		return *this;
+	}
+
+	inline T& operator[]( uint32_t index )
+	{
+		if ( index >= Count() )
+		{
+			assert( 0 );
+			return Trap();
+		}
+		return elements[ index ];
+	}
+
+
+	inline const T& operator[]( uint32_t index ) const
+	{
+		if ( index >= Count() )
+		{
+			assert( 0 );
+			return Trap();
+		}
+		return elements[ index ];
+	}
+
+
+	inline void Reset()
+	{
+		DestroyRange( elements, count );
+		count = 0;
+	}
+
+
+	inline void Reserve( const uint32_t newCapacity )
+	{
+		if ( newCapacity > capacity ) {
+			MoveTo( AllocTraits::allocate( allocator, newCapacity ), newCapacity );
+		}
+	}
+
+
+	// Moves back to inline storage, or a tighter heap block, when the elements allow it
+	inline void ShrinkToFit()
+	{
+		if ( IsInline() || ( count == capacity ) ) {
+			return;
+		}
+
+		if ( count <= N )
+		{
+			T* heap = elements;
+			const uint32_t heapCapacity = capacity;
+			Relocate( InlinePtr(), heap, count );
+			AllocTraits::deallocate( allocator, heap, heapCapacity );
+			elements = InlinePtr();
+			capacity = N;
+			return;
+		}
+
+		MoveTo( AllocTraits::allocate( allocator, count ), count );
+	}
+
+
+	inline T& Resize( const uint32_t newCount )
+	{
+		if ( newCount > count )
+		{
+			if ( newCount > capacity ) {
+				Reserve( NextCapacity( newCount ) );
+			}
+			for ( uint32_t i = count; i < newCount; ++i ) {
+				new ( elements + i ) T;
+			}
+		}
+		else
+		{
+			DestroyRange( elements + newCount, count - newCount );
+		}
+		count = newCount;
+		return Last();
+	}
+
+
+	inline T& Grow( const uint32_t addCount )
+	{
+		return Resize( addCount + count );
+	}
+
+
+	inline T& Shrink( const uint32_t subCount )
+	{
+		return Resize( ( subCount >= count ) ? 0 : ( count - subCount ) );
+	}
+
+
+	inline bool Append( const T& element )
+	{
+		Emplace( element );
+		return true;
+	}
+
+
+	inline bool Append( T&& element )
+	{
+		Emplace( std::move( element ) );
+		return true;
+	}
+
+
+	inline bool Append( const T* src, const uint32_t elementCount )
+	{
+		// Copy before relocating, src may point into the old buffer
+		const bool grow = ( ( count + elementCount ) > capacity );
+		const uint32_t newCapacity = grow ? NextCapacity( count + elementCount ) : capacity;
+		T* dst = grow ? AllocTraits::allocate( allocator, newCapacity ) : elements;
+
+		if constexpr ( IsTrivial ) {
+			memcpy( dst + count, src, elementCount * sizeof( T ) );
+		} else {
+			for ( uint32_t i = 0; i < elementCount; ++i ) {
+				new ( dst + count + i ) T( src[ i ] );
+			}
+		}
+
+		if ( grow ) {
+			MoveTo( dst, newCapacity );
+		}
+		count += elementCount;
+		return true;
+	}
+
+
+	template<typename... Args>
+	inline T* Emplace( Args&&... args )
+	{
+		if ( count < capacity )
+		{
+			T* element = new ( elements + count ) T( std::forward<Args>( args )... );
+			++count;
+			return element;
+		}
+
+		// Build the new element before relocating, args may alias the old buffer
+		const uint32_t newCapacity = NextCapacity( count + 1 );
+		T* newElements = AllocTraits::allocate( allocator, newCapacity );
+		T* element = new ( newElements + count ) T( std::forward<Args>( args )... );
+		MoveTo( newElements, newCapacity );
+		++count;
+		return element;
+	}
+
+
+	inline T* Ptr()
+	{
+		return elements;
+	}
+
+
+	inline const T* Ptr() const
+	{
+		return elements;
+	}
+
+
+	inline uint32_t Count() const
+	{
+		return count;
+	}
+
+
+	inline uint32_t Capacity() const
+	{
+		return capacity;
+	}
+
+
+	inline bool IsInline() const
+	{
+		return ( elements == reinterpret_cast<const T*>( inlineStorage ) );
+	}
+};
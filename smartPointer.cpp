@@ -0,0 +1,237 @@
+#include "smartPointer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ref.h"
+#include "timer.h"
+
+static int smartPointerTestLive = 0;
+
+struct smartPointerTestObject_t
+{
+    std::string name;
+    int         value;
+
+    smartPointerTestObject_t( const char* _name, const int _value ) : name( _name ), value( _value ) { ++smartPointerTestLive; }
+    smartPointerTestObject_t( const smartPointerTestObject_t& rhs ) : name( rhs.name ), value( rhs.value ) { ++smartPointerTestLive; }
+    ~smartPointerTestObject_t() { --smartPointerTestLive; }
+};
+
+
+void TestSmartPointer()
+{
+    using object_t = smartPointerTestObject_t;
+
+    // --- MakePtr constructs in place ---
+    {
+        ptr_t<object_t> a = MakePtr<object_t>( "a", 1 );
+        assert( a.IsValid() );
+        assert( a->name == "a" && a->value == 1 );
+        assert( smartPointerTestLive == 1 );
+
+        ptr_t<object_t> b = a;
+        assert( b == a );
+        b->value = 2;
+        assert( a->value == 2 );
+
+        a.Release();
+        assert( !a.IsValid() && a.Get() == nullptr );
+        assert( smartPointerTestLive == 1 );
+    }
+    assert( smartPointerTestLive == 0 );
+
+    // --- Copying from an object still works ---
+    {
+        const object_t source( "src", 5 );
+        ptr_t<object_t> a( source );
+        assert( smartPointerTestLive == 2 );
+        assert( a->value == 5 );
+    }
+    assert( smartPointerTestLive == 0 );
+
+    // --- Moves transfer ownership ---
+    {
+        ptr_t<object_t> a = MakePtr<object_t>( "m", 3 );
+        ptr_t<object_t> b( std::move( a ) );
+        assert( !a.IsValid() && b.IsValid() );
+
+        ptr_t<object_t> c = MakePtr<object_t>( "n", 4 );
+        c = std::move( b );
+        assert( !b.IsValid() );
+        assert( c->name == "m" );
+        assert( smartPointerTestLive == 1 );
+
+        c = c;
+        assert( c->value == 3 );
+
+        ptr_t<object_t> d;
+        d = c;
+        c = ptr_t<object_t>();
+        assert( d->value == 3 );
+        assert( smartPointerTestLive == 1 );
+    }
+    assert( smartPointerTestLive == 0 );
+
+    // --- Over-aligned types ---
+    {
+        struct alignas( 64 ) aligned_t { uint8_t bytes[ 64 ]; };
+        ptr_t<aligned_t> a = MakePtr<aligned_t>();
+        assert( ( reinterpret_cast<uintptr_t>( a.Get() ) & 63 ) == 0 );
+    }
+
+    // --- Atomic counts shared between threads ---
+    {
+        atomicPtr_t<object_t> shared = MakePtr<object_t, atomicRefCount_t>( "shared", 7 );
+        std::vector<std::thread> threads;
+        for ( uint32_t t = 0; t < 4; ++t )
+        {
+            threads.emplace_back( [&]() {
+                for ( uint32_t i = 0; i < 10000; ++i )
+                {
+                    atomicPtr_t<object_t> copy = shared;
+                    atomicPtr_t<object_t> moved( std::move( copy ) );
+                    assert( moved->value == 7 );
+                }
+            } );
+        }
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+        assert( smartPointerTestLive == 1 );
+
+        // Last owner on another thread destroys the object
+        std::thread last( [copy = shared]() mutable { copy.Release(); } );
+        shared.Release();
+        last.join();
+        assert( smartPointerTestLive == 0 );
+    }
+
+    // --- Weak pointers ---
+    {
+        weakPtr_t<object_t> weak;
+        assert( weak.Expired() && !weak.Lock().IsValid() );
+        {
+            ptr_t<object_t> strong = MakePtr<object_t>( "weak", 11 );
+            weak = strong;
+            weakPtr_t<object_t> copy = weak;
+            assert( !copy.Expired() );
+
+            ptr_t<object_t> locked = copy.Lock();
+            assert( locked == strong );
+            assert( locked->value == 11 );
+        }
+        // The object is gone but the block lives until the weak pointer goes
+        assert( smartPointerTestLive == 0 );
+        assert( weak.Expired() );
+        assert( !weak.Lock().IsValid() );
+        weak.Release();
+        assert( !weak.IsValid() );
+    }
+
+    // --- Lock races the last strong release ---
+    for ( uint32_t round = 0; round < 200; ++round )
+    {
+        atomicPtr_t<object_t> strong = MakePtr<object_t, atomicRefCount_t>( "race", 1 );
+        atomicWeakPtr_t<object_t> weak = strong;
+
+        std::thread locker( [weak]() {
+            for ( uint32_t i = 0; i < 100; ++i )
+            {
+                atomicPtr_t<object_t> locked = weak.Lock();
+                if ( locked.IsValid() ) {
+                    assert( locked->value == 1 );
+                }
+            }
+        } );
+        strong.Release();
+        locker.join();
+        assert( weak.Expired() );
+    }
+    assert( smartPointerTestLive == 0 );
+
+    // --- Locker drops its weak pointer right after Lock() ---
+    for ( uint32_t round = 0; round < 2000; ++round )
+    {
+        atomicPtr_t<object_t> strong = MakePtr<object_t, atomicRefCount_t>( "drop", 2 );
+        atomicWeakPtr_t<object_t> weak = strong;
+
+        std::thread locker( [weak = std::move( weak )]() mutable {
+            atomicPtr_t<object_t> locked = weak.Lock();
+            weak.Release();
+            if ( locked.IsValid() ) {
+                assert( locked->value == 2 );
+            }
+        } );
+        strong.Release();
+        locker.join();
+    }
+    assert( smartPointerTestLive == 0 );
+
+    // --- ref_t counts without owning ---
+    {
+        object_t object( "ref", 9 );
+        ref_t<object_t, atomicRefCount_t> a( &object );
+        ref_t<object_t, atomicRefCount_t> b = a;
+        a.Release();
+        assert( b->value == 9 );
+        b = ref_t<object_t, atomicRefCount_t>();
+        assert( !b.IsValid() );
+        assert( smartPointerTestLive == 1 );
+    }
+    assert( smartPointerTestLive == 0 );
+}
+
+
+template<typename RefCount>
+static uint64_t BenchmarkCopies( const uint32_t threadCount, const uint32_t copiesPerThread )
+{
+    ptr_t<uint64_t, RefCount> shared = MakePtr<uint64_t, RefCount>( 1ull );
+
+    SysCore::Timer timer( "ptr_t", SysCore::timerPrecision_t::MICROSECOND );
+    std::vector<std::thread> threads;
+    for ( uint32_t t = 0; t < threadCount; ++t )
+    {
+        threads.emplace_back( [&]() {
+            uint64_t sum = 0;
+            for ( uint32_t i = 0; i < copiesPerThread; ++i )
+            {
+                ptr_t<uint64_t, RefCount> copy = shared;
+                sum += *copy.Get();
+            }
+            assert( sum == copiesPerThread );
+        } );
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+    timer.Stop();
+    return std::max<uint64_t>( 1, timer.GetElapsed() );
+}
+
+
+void BenchmarkSmartPointer()
+{
+    const uint32_t copies = 1 << 22;
+    const uint32_t maxThreads = std::max( 2u, std::thread::hardware_concurrency() );
+
+    // Single thread: what the atomic policy costs code that never shares
+    {
+        const uint64_t plainUs = BenchmarkCopies<refCount_t>( 1, copies );
+        const uint64_t atomicUs = BenchmarkCopies<atomicRefCount_t>( 1, copies );
+        std::cout << "ptr_t copy+release 1 thread: refCount_t " << ( copies / plainUs ) << "M/s, atomicRefCount_t "
+            << ( copies / atomicUs ) << "M/s" << std::endl;
+    }
+
+    // Every thread hammers the same count
+    for ( uint32_t threadCount = 2; threadCount <= maxThreads; threadCount *= 2 )
+    {
+        const uint64_t elapsedUs = BenchmarkCopies<atomicRefCount_t>( threadCount, copies );
+        std::cout << "ptr_t copy+release " << threadCount << " threads contended: "
+            << ( static_cast<uint64_t>( copies ) * threadCount / elapsedUs ) << "M/s" << std::endl;
+    }
+}
@@ -3,72 +3,146 @@
 #include "refCounter.h"
 #include <assert.h>
 #include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
 
-template<typename T>
+void TestSmartPointer();
+void BenchmarkSmartPointer();
+
+// Counts and object share one allocation. The object lives in raw storage so it
+// can be destroyed when the last ptr_t goes while weakPtr_ts still hold the block.
+// All strong references together hold one weak reference, the block is freed
+// when the weak count reaches zero
+template<typename T, typename RefCount>
+struct ptrBlock_t
+{
+	RefCount				instances;
+	RefCount				weakInstances;
+	alignas( T ) uint8_t	storage[ sizeof( T ) ];
+
+	template<typename... Args>
+	ptrBlock_t( Args&&... args ) : instances( 1 ), weakInstances( 1 )
+	{
+		new ( storage ) T( std::forward<Args>( args )... );
+	}
+
+	inline T* Object()
+	{
+		return std::launder( reinterpret_cast<T*>( storage ) );
+	}
+
+	inline void ReleaseWeak()
+	{
+		if ( weakInstances.Release() == 0 ) {
+			delete this;
+		}
+	}
+
+	inline void ReleaseStrong()
+	{
+		// A single-threaded count with no weak pointer left has nobody who could
+		// take a reference, so the block can go without touching the counts.
+		// Shared counts always decrement: a Lock() on another thread may revive the
+		// count and drop its weak pointer between any two reads made here
+		if constexpr ( std::is_same_v<RefCount, refCount_t> )
+		{
+			if ( ( instances.Count() == 1 ) && ( weakInstances.Count() == 1 ) )
+			{
+				Object()->~T();
+				delete this;
+				return;
+			}
+		}
+
+		if ( instances.ReleaseShared() == 0 )
+		{
+			Object()->~T();
+			ReleaseWeak();
+		}
+	}
+};
+
+template<typename T, typename RefCount = typename refCountPolicy_t<T>::type>
+class ptr_t;
+
+template<typename T, typename RefCount = typename refCountPolicy_t<T>::type, typename... Args>
+ptr_t<T, RefCount> MakePtr( Args&&... args );
+
+template<typename T, typename RefCount = typename refCountPolicy_t<T>::type>
+class weakPtr_t;
+
+// Shared owner of one T. RefCount picks the counting policy, atomicRefCount_t
+// makes copies and releases safe across threads
+template<typename T, typename RefCount>
 class ptr_t
 {
 public:
 	ptr_t()
 	{
-		this->object = nullptr;
-		this->instances = nullptr;
+		this->block = nullptr;
 	};
 
 	ptr_t( const T& obj )
 	{
-		this->object = new T( obj );
-		this->instances = new refCount_t( 1 );
+		this->block = new ptrBlock_t<T, RefCount>( obj );
+	}
+
+	ptr_t( T&& obj )
+	{
+		this->block = new ptrBlock_t<T, RefCount>( std::move( obj ) );
 	}
 
 	ptr_t( const ptr_t& handle )
 	{
-		if ( handle.IsValid() )
-		{
-			this->object = handle.object;
-			this->instances = handle.instances;
-			this->instances->Add();
-		}
-		else {
-			this->object = nullptr;
-			this->instances = nullptr;
+		this->block = handle.block;
+		if ( IsValid() ) {
+			this->block->instances.Add();
 		}
 	}
 
+	// Takes over the reference, the count is untouched
+	ptr_t( ptr_t&& handle ) noexcept
+	{
+		this->block = handle.block;
+		handle.block = nullptr;
+	}
+
 	~ptr_t()
 	{
-		if ( IsValid() )
-		{
-			instances->Release();
-			if ( instances->IsFree() )
-			{
-				delete instances;
-				delete object;
-			}
-			instances = nullptr;
-			object = nullptr;
-		}
+		Drop();
 	}
 
 	ptr_t& operator=( const ptr_t& handle )
 	{
 		if ( this != &handle )
 		{
-			this->~ptr_t();
-			this->object = handle.object;
-			this->instances = handle.instances;
 			if ( handle.IsValid() ) {
-				this->instances->Add();
+				handle.block->instances.Add();
 			}
+			Drop();
+			this->block = handle.block;
+		}
+		return *this;
+	}
+
+	ptr_t& operator=( ptr_t&& handle ) noexcept
+	{
+		if ( this != &handle )
+		{
+			Drop();
+			this->block = handle.block;
+			handle.block = nullptr;
 		}
 		return *this;
 	}
 
 	bool operator==( const ptr_t& rhs ) const {
-		return ( object == rhs.object );
+		return ( block == rhs.block );
 	}
 
 	bool operator!=( const ptr_t& rhs ) const {
-		return ( object != rhs.object );
+		return ( block != rhs.block );
 	}
 
 	const T* operator->() const {
@@ -80,21 +154,147 @@ public:
 	}
 
 	void Release() {
-		this->~ptr_t();
+		Drop();
 	}
 
 	bool IsValid() const {
-		return ( object != nullptr ) && ( instances != nullptr );
+		return ( block != nullptr );
 	}
 
 	T* Get() {
-		return ( IsValid() && ( instances->IsFree() == false ) ) ? object : nullptr;
+		return ( IsValid() && ( block->instances.IsFree() == false ) ) ? block->Object() : nullptr;
 	}
 
 	const T* Get() const {
-		return ( IsValid() && ( instances->IsFree() == false ) ) ? object : nullptr;
+		return ( IsValid() && ( block->instances.IsFree() == false ) ) ? block->Object() : nullptr;
 	}
 private:
-	T*			object;
-	refCount_t*	instances;
-};
\ No newline at end of file
+	template<typename U, typename C, typename... Args>
+	friend ptr_t<U, C> MakePtr( Args&&... args );
+	friend class weakPtr_t<T, RefCount>;
+
+	explicit ptr_t( ptrBlock_t<T, RefCount>* _block )
+	{
+		this->block = _block;
+	}
+
+	void Drop()
+	{
+		if ( IsValid() )
+		{
+			block->ReleaseStrong();
+			block = nullptr;
+		}
+	}
+
+	ptrBlock_t<T, RefCount>*	block;
+};
+
+// Constructs T in place in the same allocation as its reference count
+template<typename T, typename RefCount, typename... Args>
+ptr_t<T, RefCount> MakePtr( Args&&... args )
+{
+	return ptr_t<T, RefCount>( new ptrBlock_t<T, RefCount>( std::forward<Args>( args )... ) );
+}
+
+// Non-owning companion to ptr_t. It keeps the control block alive but not the
+// object, and Lock() hands out a ptr_t only while some strong owner remains
+template<typename T, typename RefCount>
+class weakPtr_t
+{
+public:
+	weakPtr_t()
+	{
+		this->block = nullptr;
+	}
+
+	weakPtr_t( const ptr_t<T, RefCount>& handle )
+	{
+		this->block = handle.block;
+		if ( IsValid() ) {
+			this->block->weakInstances.Add();
+		}
+	}
+
+	weakPtr_t( const weakPtr_t& handle )
+	{
+		this->block = handle.block;
+		if ( IsValid() ) {
+			this->block->weakInstances.Add();
+		}
+	}
+
+	weakPtr_t( weakPtr_t&& handle ) noexcept
+	{
+		this->block = handle.block;
+		handle.block = nullptr;
+	}
+
+	~weakPtr_t()
+	{
+		Release();
+	}
+
+	weakPtr_t& operator=( const weakPtr_t& handle )
+	{
+		if ( this != &handle )
+		{
+			if ( handle.IsValid() ) {
+				handle.block->weakInstances.Add();
+			}
+			Release();
+			this->block = handle.block;
+		}
+		return *this;
+	}
+
+	weakPtr_t& operator=( weakPtr_t&& handle ) noexcept
+	{
+		if ( this != &handle )
+		{
+			Release();
+			this->block = handle.block;
+			handle.block = nullptr;
+		}
+		return *this;
+	}
+
+	weakPtr_t& operator=( const ptr_t<T, RefCount>& handle )
+	{
+		return ( *this = weakPtr_t( handle ) );
+	}
+
+	// Promotes to a strong reference, empty once the object is gone
+	ptr_t<T, RefCount> Lock() const
+	{
+		if ( IsValid() && block->instances.TryAdd() ) {
+			return ptr_t<T, RefCount>( block );
+		}
+		return ptr_t<T, RefCount>();
+	}
+
+	bool Expired() const {
+		return ( IsValid() == false ) || block->instances.IsFree();
+	}
+
+	void Release()
+	{
+		if ( IsValid() )
+		{
+			block->ReleaseWeak();
+			block = nullptr;
+		}
+	}
+
+	bool IsValid() const {
+		return ( block != nullptr );
+	}
+private:
+	ptrBlock_t<T, RefCount>*	block;
+};
+
+template<typename T>
+using atomicPtr_t = ptr_t<T, atomicRefCount_t>;
+
+template<typename T>
+using atomicWeakPtr_t = weakPtr_t<T, atomicRefCount_t>;
@@ -0,0 +1,95 @@
+#include "soaArray.h"
+
+#include <string>
+#include <vector>
+
+namespace SysCore
+{
+void TestSoaArray()
+{
+    // --- Append, column access and alignment ---
+    {
+        SoaArray<float, float, uint32_t> particles;
+        assert( particles.Count() == 0 );
+
+        for ( uint32_t i = 0; i < 100; ++i ) {
+            assert( particles.Append( float( i ), float( 2 * i ), i ) == i );
+        }
+        assert( particles.Count() == 100 );
+        assert( ( reinterpret_cast<uintptr_t>( particles.Ptr<0>() ) % CACHE_LINE_SIZE ) == 0 );
+        assert( ( reinterpret_cast<uintptr_t>( particles.Ptr<2>() ) % CACHE_LINE_SIZE ) == 0 );
+
+        float sum = 0.0f;
+        for ( const float y : particles.Column<1>() ) {
+            sum += y;
+        }
+        assert( sum == 9900.0f );
+        assert( particles.Column<2>()[ 42 ] == 42 );
+    }
+
+    // --- Erase-swap keeps columns in sync ---
+    {
+        SoaArray<uint32_t, std::string> rows;
+        rows.Append( 0u, std::string( "zero" ) );
+        rows.Append( 1u, std::string( "one" ) );
+        rows.Append( 2u, std::string( "two" ) );
+
+        rows.EraseSwap( 0 );
+        assert( rows.Count() == 2 );
+        assert( rows.Get<0>( 0 ) == 2 && rows.Get<1>( 0 ) == "two" );
+        assert( rows.Get<0>( 1 ) == 1 && rows.Get<1>( 1 ) == "one" );
+
+        rows.EraseSwap( 1 );
+        assert( rows.Count() == 1 );
+
+        SoaArray<uint32_t, std::string> copy = rows;
+        assert( copy.Get<1>( 0 ) == "two" );
+        SoaArray<uint32_t, std::string> moved = std::move( copy );
+        assert( moved.Count() == 1 && copy.Count() == 0 );
+
+        moved.Resize( 4 );
+        assert( moved.Get<1>( 3 ).empty() );
+        moved.Reset();
+        assert( moved.Count() == 0 );
+    }
+
+    // --- Appending values from the array's own rows while it grows ---
+    {
+        SoaArray<uint32_t, std::vector<uint32_t>> rows;
+        rows.Append( 0u, std::vector<uint32_t>( 8, 0u ) );
+        uint32_t growths = 0;
+        for ( uint32_t i = 1; i < 200; ++i )
+        {
+            const uint32_t capacity = rows.Capacity();
+            rows.Append( rows.Get<0>( i - 1 ), rows.Get<1>( i - 1 ) );
+            growths += ( rows.Capacity() != capacity ) ? 1 : 0;
+            rows.Get<0>( i ) = i;
+            rows.Get<1>( i )[ 0 ] = i;
+        }
+        assert( growths >= 4 );
+        for ( uint32_t i = 0; i < rows.Count(); ++i ) {
+            assert( rows.Get<0>( i ) == i && rows.Get<1>( i ).size() == 8 && rows.Get<1>( i )[ 0 ] == i );
+        }
+    }
+
+    // --- Serialization writes each column as a block ---
+    {
+        SoaArray<uint16_t, uint64_t> src;
+        for ( uint32_t i = 0; i < 1000; ++i ) {
+            src.Append( static_cast<uint16_t>( i ), uint64_t( i ) * 3 );
+        }
+
+        Serializer s( KB( 16 ), serializeMode_t::STORE );
+        assert( src.Serialize( &s ) );
+        assert( s.CurrentSize() == sizeof( uint32_t ) + 1000 * src.RowSize );
+
+        s.SetPosition( 0 );
+        s.SetMode( serializeMode_t::LOAD );
+
+        SoaArray<uint16_t, uint64_t> dst;
+        assert( dst.Serialize( &s ) );
+        assert( dst.Count() == 1000 );
+        assert( dst.Get<0>( 999 ) == 999 && dst.Get<1>( 999 ) == 2997 );
+    }
+}
+}
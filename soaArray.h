@@ -0,0 +1,383 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <new>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "common.h"
+#include "memTracker.h"
+#include "serializer.h"
+
+namespace SysCore
+{
+void TestSoaArray();
+
+// Contiguous view of one SoaArray column
+template<class T>
+struct SoaColumn
+{
+	T*			data;
+	uint32_t	count;
+
+	inline T& operator[]( const uint32_t index ) const
+	{
+		assert( index < count );
+		return data[ index ];
+	}
+
+	inline T* begin() const { return data; }
+	inline T* end() const { return data + count; }
+	inline uint32_t Count() const { return count; }
+};
+
+// Structure-of-arrays container. Each field type gets its own cache-line
+// aligned array, and all columns share one count so rows stay in sync
+template<class... Ts>
+class SoaArray
+{
+private:
+	static_assert( sizeof...( Ts ) > 0, "SoaArray needs at least one column" );
+
+	using Indices = std::index_sequence_for<Ts...>;
+
+	template<size_t I>
+	using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+	template<class T>
+	static constexpr bool IsTrivial = std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>;
+
+	static constexpr size_t ColumnAlignment = CACHE_LINE_SIZE;
+
+	std::tuple<Ts*...>	columns;
+	uint32_t			count;
+	uint32_t			capacity;
+
+	template<class T>
+	static inline T* AllocateColumn( const uint32_t elementCount )
+	{
+		const size_t alignment = ( alignof( T ) > ColumnAlignment ) ? alignof( T ) : ColumnAlignment;
+		MEM_TRACK_ALLOC( memTag_t::CONTAINER, static_cast<uint64_t>( elementCount ) * sizeof( T ) );
+		return static_cast<T*>( ::operator new( elementCount * sizeof( T ), std::align_val_t( alignment ) ) );
+	}
+
+	template<class T>
+	static inline void FreeColumn( T* column, const uint32_t elementCount )
+	{
+		( void )elementCount;	// Only read when allocations are tracked
+		if ( column != nullptr )
+		{
+			const size_t alignment = ( alignof( T ) > ColumnAlignment ) ? alignof( T ) : ColumnAlignment;
+			MEM_TRACK_FREE( memTag_t::CONTAINER, static_cast<uint64_t>( elementCount ) * sizeof( T ) );
+			::operator delete( column, std::align_val_t( alignment ) );
+		}
+	}
+
+	template<class T>
+	static inline void DestroyRange( T* column, const uint32_t first, const uint32_t last )
+	{
+		if constexpr ( std::is_trivially_destructible_v<T> == false )
+		{
+			for ( uint32_t i = first; i < last; ++i ) {
+				column[ i ].~T();
+			}
+		}
+	}
+
+	template<class T>
+	static inline void Relocate( T* dst, T* src, const uint32_t elementCount )
+	{
+		if constexpr ( IsTrivial<T> ) {
+			if ( elementCount > 0 ) {
+				memcpy( dst, src, elementCount * sizeof( T ) );
+			}
+		} else {
+			for ( uint32_t i = 0; i < elementCount; ++i )
+			{
+				new ( dst + i ) T( std::move( src[ i ] ) );
+				src[ i ].~T();
+			}
+		}
+	}
+
+	template<size_t... Is>
+	inline void ReallocateColumns( const uint32_t newCapacity, std::index_sequence<Is...> )
+	{
+		( ( [&]() {
+			using T = ColumnType<Is>;
+			T* newColumn = AllocateColumn<T>( newCapacity );
+			Relocate( newColumn, std::get<Is>( columns ), count );
+			FreeColumn( std::get<Is>( columns ), capacity );
+			std::get<Is>( columns ) = newColumn;
+		}() ), ... );
+	}
+
+	template<size_t... Is>
+	inline void DestroyColumns( const uint32_t first, const uint32_t last, std::index_sequence<Is...> )
+	{
+		( DestroyRange( std::get<Is>( columns ), first, last ), ... );
+	}
+
+	template<size_t... Is>
+	inline void FreeColumns( std::index_sequence<Is...> )
+	{
+		( FreeColumn( std::get<Is>( columns ), capacity ), ... );
+		( ( std::get<Is>( columns ) = nullptr ), ... );
+	}
+
+	template<size_t... Is>
+	inline void DefaultConstructRows( const uint32_t first, const uint32_t last, std::index_sequence<Is...> )
+	{
+		for ( uint32_t i = first; i < last; ++i ) {
+			( new ( std::get<Is>( columns ) + i ) ColumnType<Is>, ... );
+		}
+	}
+
+	template<size_t... Is, typename... Args>
+	inline void ConstructRow( const uint32_t row, std::index_sequence<Is...>, Args&&... args )
+	{
+		( new ( std::get<Is>( columns ) + row ) ColumnType<Is>( std::forward<Args>( args ) ), ... );
+	}
+
+	template<size_t... Is>
+	inline void MoveConstructRow( const uint32_t row, std::index_sequence<Is...>, std::tuple<Ts...>& values )
+	{
+		( new ( std::get<Is>( columns ) + row ) ColumnType<Is>( std::move( std::get<Is>( values ) ) ), ... );
+	}
+
+	template<size_t... Is>
+	inline void CopyRows( const SoaArray& rhs, std::index_sequence<Is...> )
+	{
+		( ( [&]() {
+			using T = ColumnType<Is>;
+			const T* src = std::get<Is>( rhs.columns );
+			T* dst = std::get<Is>( columns );
+			if constexpr ( IsTrivial<T> ) {
+				if ( rhs.count > 0 ) {
+					memcpy( dst, src, rhs.count * sizeof( T ) );
+				}
+			} else {
+				for ( uint32_t i = 0; i < rhs.count; ++i ) {
+					new ( dst + i ) T( src[ i ] );
+				}
+			}
+		}() ), ... );
+	}
+
+	template<size_t... Is>
+	inline void MoveRow( const uint32_t dst, const uint32_t src, std::index_sequence<Is...> )
+	{
+		( ( std::get<Is>( columns )[ dst ] = std::move( std::get<Is>( columns )[ src ] ) ), ... );
+	}
+
+	template<size_t... Is>
+	inline void SerializeColumns( Serializer* s, std::index_sequence<Is...> )
+	{
+		( SerializeArray( s, std::get<Is>( columns ), count ), ... );
+	}
+
+	inline void GrowFor( const uint32_t required )
+	{
+		if ( required > capacity )
+		{
+			const uint32_t doubled = ( capacity > ( UINT32_MAX / 2 ) ) ? UINT32_MAX : ( 2 * capacity );
+			Reserve( ( doubled > required ) ? doubled : required );
+		}
+	}
+
+public:
+
+	static constexpr uint32_t ColumnCount = sizeof...( Ts );
+	static constexpr uint32_t RowSize = static_cast<uint32_t>( ( sizeof( Ts ) + ... ) );
+
+	SoaArray() : count( 0 ), capacity( 0 )
+	{}
+
+	SoaArray( const SoaArray& rhs ) : count( 0 ), capacity( 0 )
+	{
+		Reserve( rhs.count );
+		CopyRows( rhs, Indices() );
+		count = rhs.count;
+	}
+
+	SoaArray( SoaArray&& rhs ) noexcept : columns( rhs.columns ), count( rhs.count ), capacity( rhs.capacity )
+	{
+		rhs.columns = std::tuple<Ts*...>();
+		rhs.count = 0;
+		rhs.capacity = 0;
+	}
+
+	~SoaArray()
+	{
+		Reset();
+		FreeColumns( Indices() );
+	}
+
+	SoaArray& operator=( const SoaArray& rhs )
+	{
+		if ( this != &rhs )
+		{
+			Reset();
+			Reserve( rhs.count );
+			CopyRows( rhs, Indices() );
+			count = rhs.count;
+		}
+		return *this;
+	}
+
+	SoaArray& operator=( SoaArray&& rhs ) noexcept
+	{
+		if ( this != &rhs )
+		{
+			Reset();
+			FreeColumns( Indices() );
+			columns = rhs.columns;
+			count = rhs.count;
+			capacity = rhs.capacity;
+			rhs.columns = std::tuple<Ts*...>();
+			rhs.count = 0;
+			rhs.capacity = 0;
+		}
+		return *this;
+	}
+
+	inline void Reserve( const uint32_t newCapacity )
+	{
+		if ( newCapacity > capacity )
+		{
+			ReallocateColumns( newCapacity, Indices() );
+			capacity = newCapacity;
+		}
+	}
+
+	// Appends one row, returns its index
+	template<typename... Args>
+	inline uint32_t Append( Args&&... args )
+	{
+		static_assert( sizeof...( Args ) == sizeof...( Ts ), "Append takes one value per column" );
+		if ( count < capacity )
+		{
+			ConstructRow( count, Indices(), std::forward<Args>( args )... );
+			return count++;
+		}
+
+		// Build the row before growing, args may reference rows in the old columns
+		std::tuple<Ts...> values( std::forward<Args>( args )... );
+		GrowFor( count + 1 );
+		MoveConstructRow( count, Indices(), values );
+		return count++;
+	}
+
+	// Moves the last row into the erased one, so row order is not kept
+	inline void EraseSwap( const uint32_t row )
+	{
+		if ( row >= count )
+		{
+			assert( 0 );
+			return;
+		}
+
+		const uint32_t last = count - 1;
+		if ( row != last ) {
+			MoveRow( row, last, Indices() );
+		}
+		DestroyColumns( last, count, Indices() );
+		--count;
+	}
+
+	inline void Resize( const uint32_t newCount )
+	{
+		if ( newCount > count )
+		{
+			GrowFor( newCount );
+			DefaultConstructRows( count, newCount, Indices() );
+		}
+		else
+		{
+			DestroyColumns( newCount, count, Indices() );
+		}
+		count = newCount;
+	}
+
+	inline void Reset()
+	{
+		DestroyColumns( 0, count, Indices() );
+		count = 0;
+	}
+
+	template<size_t I>
+	inline ColumnType<I>* Ptr()
+	{
+		return std::get<I>( columns );
+	}
+
+	template<size_t I>
+	inline const ColumnType<I>* Ptr() const
+	{
+		return std::get<I>( columns );
+	}
+
+	template<size_t I>
+	inline SoaColumn<ColumnType<I>> Column()
+	{
+		return SoaColumn<ColumnType<I>>{ std::get<I>( columns ), count };
+	}
+
+	template<size_t I>
+	inline SoaColumn<const ColumnType<I>> Column() const
+	{
+		return SoaColumn<const ColumnType<I>>{ std::get<I>( columns ), count };
+	}
+
+	template<size_t I>
+	inline ColumnType<I>& Get( const uint32_t row )
+	{
+		assert( row < count );
+		return std::get<I>( columns )[ row ];
+	}
+
+	template<size_t I>
+	inline const ColumnType<I>& Get( const uint32_t row ) const
+	{
+		assert( row < count );
+		return std::get<I>( columns )[ row ];
+	}
+
+	inline uint32_t Count() const
+	{
+		return count;
+	}
+
+	inline uint32_t Capacity() const
+	{
+		return capacity;
+	}
+
+	// Stores or loads the row count followed by each column as one contiguous block.
+	// Returns false on a malformed load
+	bool Serialize( Serializer* s )
+	{
+		static_assert( ( std::is_trivially_copyable_v<Ts> && ... ), "SoaArray serialization needs trivially copyable columns" );
+
+		uint32_t rowCount = count;
+		s->Next( rowCount );
+
+		if ( s->GetMode() == serializeMode_t::LOAD )
+		{
+			const uint64_t remaining = s->BufferSize() - s->CurrentSize();
+			if ( ( s->Status() != serializeStatus_t::OK ) || ( static_cast<uint64_t>( rowCount ) * RowSize > remaining ) )
+			{
+				Reset();
+				return false;
+			}
+			Resize( rowCount );
+		}
+
+		SerializeColumns( s, Indices() );
+		return ( s->Status() == serializeStatus_t::OK );
+	}
+};
+}
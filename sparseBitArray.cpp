@@ -0,0 +1,1015 @@
+#include "sparseBitArray.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "serializer.h"
+
+namespace SysCore
+{
+static inline void SetWordBits( uint64_t* words, const uint32_t first, const uint32_t last )
+{
+	const uint32_t firstWord = first / 64;
+	const uint32_t lastWord = last / 64;
+	const uint64_t firstMask = ~uint64_t( 0 ) << ( first % 64 );
+	const uint64_t lastMask = ~uint64_t( 0 ) >> ( 63 - ( last % 64 ) );
+
+	if ( firstWord == lastWord )
+	{
+		words[ firstWord ] |= ( firstMask & lastMask );
+		return;
+	}
+
+	words[ firstWord ] |= firstMask;
+	for ( uint32_t i = firstWord + 1; i < lastWord; ++i ) {
+		words[ i ] = ~uint64_t( 0 );
+	}
+	words[ lastWord ] |= lastMask;
+}
+
+
+bool SparseBitArray::container_t::Contains( const uint16_t low ) const
+{
+	if ( type == containerType_t::BITMAP ) {
+		return ( words[ low / 64 ] & ( uint64_t( 1 ) << ( low % 64 ) ) ) != 0;
+	}
+
+	if ( type == containerType_t::ARRAY ) {
+		return std::binary_search( values.begin(), values.end(), low );
+	}
+
+	// Find the last run starting at or before low
+	const uint32_t runCount = static_cast<uint32_t>( values.size() / 2 );
+	uint32_t lo = 0;
+	uint32_t hi = runCount;
+	while ( lo < hi )
+	{
+		const uint32_t mid = ( lo + hi ) / 2;
+		if ( values[ 2 * mid ] <= low ) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if ( lo == 0 ) {
+		return false;
+	}
+	const uint32_t runIx = lo - 1;
+	return ( low - values[ 2 * runIx ] ) <= values[ 2 * runIx + 1 ];
+}
+
+
+// Checks the invariants the other container functions rely on, for untrusted loads
+bool SparseBitArray::container_t::IsValid() const
+{
+	// Containers are removed once they empty out, so none is ever stored empty
+	if ( cardinality == 0 ) {
+		return false;
+	}
+
+	if ( type == containerType_t::BITMAP )
+	{
+		if ( words.size() != BitmapWordCount ) {
+			return false;
+		}
+		uint32_t bitCount = 0;
+		for ( const uint64_t word : words ) {
+			bitCount += Popcount( word );
+		}
+		return ( bitCount == cardinality );
+	}
+
+	if ( type == containerType_t::ARRAY )
+	{
+		if ( values.size() != cardinality ) {
+			return false;
+		}
+		for ( size_t i = 1; i < values.size(); ++i )
+		{
+			if ( values[ i ] <= values[ i - 1 ] ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	if ( ( values.size() % 2 ) != 0 ) {
+		return false;
+	}
+
+	// Runs are ( start, length - 1 ) pairs, ascending, non-overlapping and inside the chunk
+	uint32_t bitCount = 0;
+	uint32_t nextFree = 0;
+	for ( size_t i = 0; i < values.size(); i += 2 )
+	{
+		const uint32_t start = values[ i ];
+		const uint32_t last = start + values[ i + 1 ];
+		if ( ( ( i > 0 ) && ( start < nextFree ) ) || ( last >= ChunkBits ) ) {
+			return false;
+		}
+		bitCount += values[ i + 1 ] + 1;
+		nextFree = last + 1;
+	}
+	return ( bitCount == cardinality );
+}
+
+
+bool SparseBitArray::container_t::Add( const uint16_t low )
+{
+	if ( type == containerType_t::RUN )
+	{
+		if ( Contains( low ) ) {
+			return false;
+		}
+		Expand();
+	}
+
+	if ( type == containerType_t::ARRAY )
+	{
+		auto it = std::lower_bound( values.begin(), values.end(), low );
+		if ( ( it != values.end() ) && ( *it == low ) ) {
+			return false;
+		}
+
+		if ( cardinality < ArrayMaxCardinality )
+		{
+			values.insert( it, low );
+			++cardinality;
+			return true;
+		}
+
+		uint64_t dense[ BitmapWordCount ] = {};
+		OrInto( dense );
+		type = containerType_t::BITMAP;
+		words.assign( dense, dense + BitmapWordCount );
+		values.clear();
+		values.shrink_to_fit();
+	}
+
+	const uint64_t mask = uint64_t( 1 ) << ( low % 64 );
+	uint64_t& word = words[ low / 64 ];
+	if ( ( word & mask ) != 0 ) {
+		return false;
+	}
+	word |= mask;
+	++cardinality;
+	return true;
+}
+
+
+bool SparseBitArray::container_t::Remove( const uint16_t low )
+{
+	if ( type == containerType_t::RUN )
+	{
+		if ( Contains( low ) == false ) {
+			return false;
+		}
+		Expand();
+	}
+
+	if ( type == containerType_t::ARRAY )
+	{
+		auto it = std::lower_bound( values.begin(), values.end(), low );
+		if ( ( it == values.end() ) || ( *it != low ) ) {
+			return false;
+		}
+		values.erase( it );
+		--cardinality;
+		return true;
+	}
+
+	const uint64_t mask = uint64_t( 1 ) << ( low % 64 );
+	uint64_t& word = words[ low / 64 ];
+	if ( ( word & mask ) == 0 ) {
+		return false;
+	}
+	word &= ~mask;
+	--cardinality;
+
+	if ( cardinality <= ArrayMaxCardinality ) {
+		FromWords( words.data() );
+	}
+	return true;
+}
+
+
+uint32_t SparseBitArray::container_t::RunCount() const
+{
+	if ( type == containerType_t::RUN ) {
+		return static_cast<uint32_t>( values.size() / 2 );
+	}
+
+	if ( type == containerType_t::ARRAY )
+	{
+		uint32_t runs = 0;
+		for ( uint32_t i = 0; i < cardinality; ++i )
+		{
+			if ( ( i == 0 ) || ( values[ i ] != values[ i - 1 ] + 1 ) ) {
+				++runs;
+			}
+		}
+		return runs;
+	}
+
+	// A run starts wherever a set bit follows a clear bit
+	uint32_t runs = 0;
+	uint64_t carry = 0;
+	for ( uint32_t i = 0; i < BitmapWordCount; ++i )
+	{
+		const uint64_t word = words[ i ];
+		runs += SysCore::Popcount( word & ~( ( word << 1 ) | carry ) );
+		carry = word >> 63;
+	}
+	return runs;
+}
+
+
+void SparseBitArray::container_t::OrInto( uint64_t* outWords ) const
+{
+	if ( type == containerType_t::BITMAP )
+	{
+		for ( uint32_t i = 0; i < BitmapWordCount; ++i ) {
+			outWords[ i ] |= words[ i ];
+		}
+	}
+	else if ( type == containerType_t::ARRAY )
+	{
+		for ( const uint16_t low : values ) {
+			outWords[ low / 64 ] |= ( uint64_t( 1 ) << ( low % 64 ) );
+		}
+	}
+	else
+	{
+		for ( size_t i = 0; i < values.size(); i += 2 ) {
+			SetWordBits( outWords, values[ i ], values[ i ] + values[ i + 1 ] );
+		}
+	}
+}
+
+
+void SparseBitArray::container_t::FromWords( const uint64_t* inWords )
+{
+	uint32_t count = 0;
+	for ( uint32_t i = 0; i < BitmapWordCount; ++i ) {
+		count += SysCore::Popcount( inWords[ i ] );
+	}
+
+	if ( count > ArrayMaxCardinality )
+	{
+		if ( inWords != words.data() ) {
+			words.assign( inWords, inWords + BitmapWordCount );
+		}
+		values.clear();
+		values.shrink_to_fit();
+		type = containerType_t::BITMAP;
+		cardinality = count;
+		return;
+	}
+
+	storage_t<uint16_t> sparse;
+	sparse.reserve( count );
+	for ( uint32_t i = 0; i < BitmapWordCount; ++i )
+	{
+		uint64_t word = inWords[ i ];
+		while ( word != 0 )
+		{
+			sparse.push_back( static_cast<uint16_t>( i * 64 + SysCore::CountTrailingZeros( word ) ) );
+			word &= ( word - 1 );
+		}
+	}
+
+	values.swap( sparse );
+	words.clear();
+	words.shrink_to_fit();
+	type = containerType_t::ARRAY;
+	cardinality = count;
+}
+
+
+void SparseBitArray::container_t::Expand()
+{
+	if ( type != containerType_t::RUN ) {
+		return;
+	}
+
+	uint64_t dense[ BitmapWordCount ] = {};
+	OrInto( dense );
+	FromWords( dense );
+}
+
+
+void SparseBitArray::container_t::Optimize()
+{
+	// Serialized payload sizes in bytes for each representation
+	const uint32_t runBytes = 4 * RunCount();
+	const uint32_t arrayBytes = 2 * cardinality;
+	const uint32_t bitmapBytes = 8 * BitmapWordCount;
+
+	if ( runBytes < std::min( arrayBytes, bitmapBytes ) )
+	{
+		if ( type == containerType_t::RUN ) {
+			return;
+		}
+
+		uint64_t dense[ BitmapWordCount ] = {};
+		OrInto( dense );
+
+		storage_t<uint16_t> runs;
+		runs.reserve( 2 * ( runBytes / 4 ) );
+		uint32_t bit = 0;
+		while ( bit < ChunkBits )
+		{
+			const uint32_t wordIx = bit / 64;
+			const uint64_t remaining = dense[ wordIx ] >> ( bit % 64 );
+			if ( remaining == 0 )
+			{
+				bit = ( wordIx + 1 ) * 64;
+				continue;
+			}
+			bit += SysCore::CountTrailingZeros( remaining );
+
+			const uint32_t start = bit;
+			while ( bit < ChunkBits )
+			{
+				const uint32_t runWordIx = bit / 64;
+				const uint64_t clear = ~dense[ runWordIx ] >> ( bit % 64 );
+				const uint32_t length = std::min( SysCore::CountTrailingZeros( clear ), 64 - ( bit % 64 ) );
+				bit += length;
+				if ( ( length == 0 ) || ( ( bit % 64 ) != 0 ) ) {
+					break;
+				}
+			}
+			runs.push_back( static_cast<uint16_t>( start ) );
+			runs.push_back( static_cast<uint16_t>( bit - start - 1 ) );
+		}
+
+		values.swap( runs );
+		values.shrink_to_fit();
+		words.clear();
+		words.shrink_to_fit();
+		type = containerType_t::RUN;
+	}
+	else
+	{
+		Expand();
+		values.shrink_to_fit();
+	}
+}
+
+
+SparseBitArray::container_t SparseBitArray::container_t::Union( const container_t& a, const container_t& b )
+{
+	container_t result;
+	if ( ( a.type == containerType_t::ARRAY ) && ( b.type == containerType_t::ARRAY ) && ( ( a.cardinality + b.cardinality ) <= ArrayMaxCardinality ) )
+	{
+		result.values.reserve( a.cardinality + b.cardinality );
+		std::set_union( a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter( result.values ) );
+		result.cardinality = static_cast<uint32_t>( result.values.size() );
+		return result;
+	}
+
+	uint64_t dense[ BitmapWordCount ] = {};
+	a.OrInto( dense );
+	b.OrInto( dense );
+	result.FromWords( dense );
+	return result;
+}
+
+
+SparseBitArray::container_t SparseBitArray::container_t::Intersect( const container_t& a, const container_t& b )
+{
+	container_t result;
+	if ( ( a.type == containerType_t::ARRAY ) && ( b.type == containerType_t::ARRAY ) )
+	{
+		result.values.reserve( std::min( a.cardinality, b.cardinality ) );
+		std::set_intersection( a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter( result.values ) );
+		result.cardinality = static_cast<uint32_t>( result.values.size() );
+		return result;
+	}
+
+	if ( ( a.type == containerType_t::ARRAY ) || ( b.type == containerType_t::ARRAY ) )
+	{
+		const container_t& sparse = ( a.type == containerType_t::ARRAY ) ? a : b;
+		const container_t& other = ( a.type == containerType_t::ARRAY ) ? b : a;
+		for ( const uint16_t low : sparse.values )
+		{
+			if ( other.Contains( low ) ) {
+				result.values.push_back( low );
+			}
+		}
+		result.cardinality = static_cast<uint32_t>( result.values.size() );
+		return result;
+	}
+
+	uint64_t denseA[ BitmapWordCount ] = {};
+	uint64_t denseB[ BitmapWordCount ] = {};
+	a.OrInto( denseA );
+	b.OrInto( denseB );
+	for ( uint32_t i = 0; i < BitmapWordCount; ++i ) {
+		denseA[ i ] &= denseB[ i ];
+	}
+	result.FromWords( denseA );
+	return result;
+}
+
+
+SparseBitArray::Iterator::Iterator( const SparseBitArray* _owner, const uint32_t _containerIx )
+	: owner( _owner ), containerIx( _containerIx ), cursor( 0 ), low( 0 )
+{
+	Seek();
+}
+
+
+// Positions the iterator on the first value at or after ( containerIx, cursor, low )
+void SparseBitArray::Iterator::Seek()
+{
+	const uint32_t containerCount = static_cast<uint32_t>( owner->containers.size() );
+	while ( containerIx < containerCount )
+	{
+		const container_t& c = owner->containers[ containerIx ];
+		if ( c.type == containerType_t::ARRAY )
+		{
+			if ( cursor < c.values.size() )
+			{
+				low = c.values[ cursor ];
+				return;
+			}
+		}
+		else if ( c.type == containerType_t::RUN )
+		{
+			if ( ( 2 * cursor ) < c.values.size() )
+			{
+				low = std::max<uint32_t>( low, c.values[ 2 * cursor ] );
+				return;
+			}
+		}
+		else
+		{
+			uint32_t wordIx = low / 64;
+			uint64_t word = ( wordIx < BitmapWordCount ) ? ( c.words[ wordIx ] >> ( low % 64 ) << ( low % 64 ) ) : 0;
+			while ( ( word == 0 ) && ( ++wordIx < BitmapWordCount ) ) {
+				word = c.words[ wordIx ];
+			}
+			if ( word != 0 )
+			{
+				low = wordIx * 64 + SysCore::CountTrailingZeros( word );
+				return;
+			}
+		}
+
+		++containerIx;
+		cursor = 0;
+		low = 0;
+	}
+}
+
+
+uint32_t SparseBitArray::Iterator::operator*() const
+{
+	return ( static_cast<uint32_t>( owner->keys[ containerIx ] ) << 16 ) | low;
+}
+
+
+SparseBitArray::Iterator& SparseBitArray::Iterator::operator++()
+{
+	const container_t& c = owner->containers[ containerIx ];
+	if ( c.type == containerType_t::ARRAY )
+	{
+		++cursor;
+	}
+	else if ( c.type == containerType_t::RUN )
+	{
+		const uint32_t runEnd = c.values[ 2 * cursor ] + c.values[ 2 * cursor + 1 ];
+		if ( low < runEnd )
+		{
+			++low;
+			return *this;
+		}
+		++cursor;
+	}
+	else
+	{
+		++low;
+	}
+	Seek();
+	return *this;
+}
+
+
+int32_t SparseBitArray::FindContainer( const uint16_t key ) const
+{
+	auto it = std::lower_bound( keys.begin(), keys.end(), key );
+	if ( ( it == keys.end() ) || ( *it != key ) ) {
+		return -1;
+	}
+	return static_cast<int32_t>( it - keys.begin() );
+}
+
+
+void SparseBitArray::Reset()
+{
+	keys.clear();
+	containers.clear();
+}
+
+
+void SparseBitArray::Set( const uint32_t element )
+{
+	const uint16_t key = static_cast<uint16_t>( element >> 16 );
+	const uint16_t low = static_cast<uint16_t>( element & 0xFFFF );
+
+	auto it = std::lower_bound( keys.begin(), keys.end(), key );
+	const size_t containerIx = static_cast<size_t>( it - keys.begin() );
+	if ( ( it == keys.end() ) || ( *it != key ) )
+	{
+		keys.insert( it, key );
+		containers.insert( containers.begin() + containerIx, container_t() );
+	}
+	containers[ containerIx ].Add( low );
+}
+
+
+void SparseBitArray::Clear( const uint32_t element )
+{
+	const int32_t containerIx = FindContainer( static_cast<uint16_t>( element >> 16 ) );
+	if ( containerIx < 0 ) {
+		return;
+	}
+
+	container_t& c = containers[ containerIx ];
+	if ( c.Remove( static_cast<uint16_t>( element & 0xFFFF ) ) && ( c.cardinality == 0 ) )
+	{
+		keys.erase( keys.begin() + containerIx );
+		containers.erase( containers.begin() + containerIx );
+	}
+}
+
+
+uint32_t SparseBitArray::Count() const
+{
+	uint32_t count = 0;
+	for ( const container_t& c : containers ) {
+		count += c.cardinality;
+	}
+	return count;
+}
+
+
+bool SparseBitArray::AnySet() const
+{
+	return ( NoneSet() == false );
+}
+
+
+bool SparseBitArray::NoneSet() const
+{
+	return containers.empty();
+}
+
+
+bool SparseBitArray::IsSet( const uint32_t element ) const
+{
+	const int32_t containerIx = FindContainer( static_cast<uint16_t>( element >> 16 ) );
+	if ( containerIx < 0 ) {
+		return false;
+	}
+	return containers[ containerIx ].Contains( static_cast<uint16_t>( element & 0xFFFF ) );
+}
+
+
+void SparseBitArray::Optimize()
+{
+	for ( container_t& c : containers ) {
+		c.Optimize();
+	}
+	keys.shrink_to_fit();
+	containers.shrink_to_fit();
+}
+
+
+size_t SparseBitArray::MemoryUsage() const
+{
+	size_t bytes = sizeof( SparseBitArray );
+	bytes += keys.capacity() * sizeof( uint16_t );
+	bytes += containers.capacity() * sizeof( container_t );
+	for ( const container_t& c : containers )
+	{
+		bytes += c.values.capacity() * sizeof( uint16_t );
+		bytes += c.words.capacity() * sizeof( uint64_t );
+	}
+	return bytes;
+}
+
+
+bool SparseBitArray::Serialize( Serializer* s )
+{
+	const bool loading = ( s->GetMode() == serializeMode_t::LOAD );
+
+	uint32_t containerCount = static_cast<uint32_t>( containers.size() );
+	s->Next( containerCount );
+
+	if ( loading )
+	{
+		if ( ( s->Status() != serializeStatus_t::OK ) || ( containerCount > ChunkBits ) )
+		{
+			Reset();
+			return false;
+		}
+		keys.resize( containerCount );
+		containers.resize( containerCount );
+	}
+
+	for ( uint32_t i = 0; i < containerCount; ++i )
+	{
+		container_t& c = containers[ i ];
+
+		uint8_t type = static_cast<uint8_t>( c.type );
+		uint32_t payloadCount = static_cast<uint32_t>( ( c.type == containerType_t::BITMAP ) ? c.words.size() : c.values.size() );
+
+		s->Next( keys[ i ] );
+		s->Next( type );
+		s->Next( c.cardinality );
+		s->Next( payloadCount );
+
+		if ( loading )
+		{
+			const bool validType = ( type <= static_cast<uint8_t>( containerType_t::RUN ) );
+			const uint32_t maxPayload = ( type == static_cast<uint8_t>( containerType_t::BITMAP ) ) ? BitmapWordCount : ChunkBits;
+			if ( ( s->Status() != serializeStatus_t::OK ) || !validType || ( payloadCount > maxPayload ) )
+			{
+				Reset();
+				return false;
+			}
+
+			c.type = static_cast<containerType_t>( type );
+			if ( c.type == containerType_t::BITMAP ) {
+				c.words.resize( payloadCount );
+			} else {
+				c.values.resize( payloadCount );
+			}
+		}
+
+		if ( c.type == containerType_t::BITMAP ) {
+			SerializeArray( s, c.words.data(), payloadCount );
+		} else {
+			SerializeArray( s, c.values.data(), payloadCount );
+		}
+
+		if ( loading )
+		{
+			const bool keyOrdered = ( i == 0 ) || ( keys[ i ] > keys[ i - 1 ] );
+			if ( ( s->Status() != serializeStatus_t::OK ) || !keyOrdered || !c.IsValid() )
+			{
+				Reset();
+				return false;
+			}
+		}
+	}
+
+	if ( loading && ( s->Status() != serializeStatus_t::OK ) )
+	{
+		Reset();
+		return false;
+	}
+	return true;
+}
+
+
+SparseBitArray& SparseBitArray::operator|=( const SparseBitArray& rhs )
+{
+	storage_t<uint16_t> mergedKeys;
+	storage_t<container_t> merged;
+	mergedKeys.reserve( keys.size() + rhs.keys.size() );
+	merged.reserve( keys.size() + rhs.keys.size() );
+
+	size_t i = 0;
+	size_t j = 0;
+	while ( ( i < keys.size() ) || ( j < rhs.keys.size() ) )
+	{
+		if ( ( j == rhs.keys.size() ) || ( ( i < keys.size() ) && ( keys[ i ] < rhs.keys[ j ] ) ) )
+		{
+			mergedKeys.push_back( keys[ i ] );
+			merged.push_back( std::move( containers[ i ] ) );
+			++i;
+		}
+		else if ( ( i == keys.size() ) || ( rhs.keys[ j ] < keys[ i ] ) )
+		{
+			mergedKeys.push_back( rhs.keys[ j ] );
+			merged.push_back( rhs.containers[ j ] );
+			++j;
+		}
+		else
+		{
+			mergedKeys.push_back( keys[ i ] );
+			merged.push_back( container_t::Union( containers[ i ], rhs.containers[ j ] ) );
+			++i;
+			++j;
+		}
+	}
+
+	keys.swap( mergedKeys );
+	containers.swap( merged );
+	return *this;
+}
+
+
+SparseBitArray& SparseBitArray::operator&=( const SparseBitArray& rhs )
+{
+	storage_t<uint16_t> mergedKeys;
+	storage_t<container_t> merged;
+
+	size_t i = 0;
+	size_t j = 0;
+	while ( ( i < keys.size() ) && ( j < rhs.keys.size() ) )
+	{
+		if ( keys[ i ] < rhs.keys[ j ] ) {
+			++i;
+		} else if ( rhs.keys[ j ] < keys[ i ] ) {
+			++j;
+		}
+		else
+		{
+			container_t c = container_t::Intersect( containers[ i ], rhs.containers[ j ] );
+			if ( c.cardinality > 0 )
+			{
+				mergedKeys.push_back( keys[ i ] );
+				merged.push_back( std::move( c ) );
+			}
+			++i;
+			++j;
+		}
+	}
+
+	keys.swap( mergedKeys );
+	containers.swap( merged );
+	return *this;
+}
+
+
+SparseBitArray SparseBitArray::operator|( const SparseBitArray& rhs ) const
+{
+	SparseBitArray result = *this;
+	result |= rhs;
+	return result;
+}
+
+
+SparseBitArray SparseBitArray::operator&( const SparseBitArray& rhs ) const
+{
+	SparseBitArray result = *this;
+	result &= rhs;
+	return result;
+}
+
+
+void TestSparseBitArray()
+{
+    // --- Construction ---
+    {
+        SparseBitArray b;
+        assert( b.NoneSet() );
+        assert( !b.AnySet() );
+        assert( b.Count() == 0 );
+        assert( b.begin() == b.end() );
+    }
+
+    // --- Set, IsSet, Clear across the 32-bit range ---
+    {
+        SparseBitArray b;
+        const uint32_t values[] = { 0, 1, 65535, 65536, 1000000, 0x7FFFFFFF, 0xFFFFFFFF };
+        for ( uint32_t i = 0; i < COUNTARRAY( values ); ++i ) {
+            b.Set( values[ i ] );
+        }
+        b.Set( 65536 );
+        assert( b.Count() == COUNTARRAY( values ) );
+        for ( uint32_t i = 0; i < COUNTARRAY( values ); ++i ) {
+            assert( b.IsSet( values[ i ] ) );
+        }
+        assert( !b.IsSet( 2 ) );
+        assert( !b.IsSet( 0xFFFFFFFE ) );
+
+        // Memory follows cardinality, not the maximum value
+        assert( b.MemoryUsage() < KB( 4 ) );
+
+        uint32_t visited = 0;
+        for ( const uint32_t value : b )
+        {
+            assert( value == values[ visited ] );
+            ++visited;
+        }
+        assert( visited == COUNTARRAY( values ) );
+
+        b.Clear( 0xFFFFFFFF );
+        b.Clear( 12345 );
+        assert( !b.IsSet( 0xFFFFFFFF ) );
+        assert( b.Count() == COUNTARRAY( values ) - 1 );
+
+        b.Reset();
+        assert( b.NoneSet() );
+    }
+
+    // --- Array to bitmap conversion and back ---
+    {
+        SparseBitArray b;
+        for ( uint32_t i = 0; i < 10000; ++i ) {
+            b.Set( 3 * i );
+        }
+        assert( b.Count() == 10000 );
+        assert( b.IsSet( 29997 ) && !b.IsSet( 29998 ) );
+
+        uint32_t expected = 0;
+        for ( const uint32_t value : b )
+        {
+            assert( value == expected );
+            expected += 3;
+        }
+        assert( expected == 30000 );
+
+        for ( uint32_t i = 0; i < 9000; ++i ) {
+            b.Clear( 3 * i );
+        }
+        assert( b.Count() == 1000 );
+        assert( b.IsSet( 27000 ) && !b.IsSet( 26997 ) );
+    }
+
+    // --- Run encoding ---
+    {
+        SparseBitArray b;
+        for ( uint32_t i = 100; i < 60000; ++i ) {
+            b.Set( i );
+        }
+        for ( uint32_t i = 70000; i < 70010; ++i ) {
+            b.Set( i );
+        }
+        const size_t before = b.MemoryUsage();
+        b.Optimize();
+        assert( b.MemoryUsage() < before );
+        assert( b.Count() == 59900 + 10 );
+        assert( b.IsSet( 100 ) && b.IsSet( 59999 ) && !b.IsSet( 99 ) && !b.IsSet( 60000 ) );
+        assert( b.IsSet( 70005 ) && !b.IsSet( 70010 ) );
+
+        uint32_t visited = 0;
+        uint32_t last = 0;
+        for ( const uint32_t value : b )
+        {
+            assert( ( visited == 0 ) || ( value > last ) );
+            last = value;
+            ++visited;
+        }
+        assert( visited == 59910 );
+
+        // Writing into a run chunk unpacks it
+        b.Clear( 500 );
+        b.Set( 60000 );
+        assert( !b.IsSet( 500 ) && b.IsSet( 60000 ) );
+        assert( b.Count() == 59910 );
+    }
+
+    // --- Union and intersection ---
+    {
+        SparseBitArray a;
+        SparseBitArray b;
+        for ( uint32_t i = 0; i < 20000; ++i ) {
+            a.Set( 2 * i );
+        }
+        for ( uint32_t i = 0; i < 20000; ++i ) {
+            b.Set( 3 * i );
+        }
+        a.Set( 0x10000000 );
+        b.Set( 0x20000000 );
+
+        const SparseBitArray u = a | b;
+        const SparseBitArray n = a & b;
+
+        uint32_t unionCount = 0;
+        uint32_t interCount = 0;
+        for ( uint32_t i = 0; i < 60000; ++i )
+        {
+            const bool inA = ( i % 2 == 0 ) && ( i < 40000 );
+            const bool inB = ( i % 3 == 0 );
+            assert( u.IsSet( i ) == ( inA || inB ) );
+            assert( n.IsSet( i ) == ( inA && inB ) );
+            unionCount += ( inA || inB ) ? 1 : 0;
+            interCount += ( inA && inB ) ? 1 : 0;
+        }
+        assert( u.Count() == unionCount + 2 );
+        assert( n.Count() == interCount );
+        assert( u.IsSet( 0x10000000 ) && u.IsSet( 0x20000000 ) );
+        assert( !n.IsSet( 0x10000000 ) );
+
+        a.Optimize();
+        const SparseBitArray nr = a & b;
+        assert( nr.Count() == n.Count() );
+    }
+
+    // --- Serialization ---
+    {
+        SparseBitArray b;
+        for ( uint32_t i = 0; i < 5000; ++i ) {
+            b.Set( i * 7 );
+        }
+        for ( uint32_t i = 1000000; i < 1010000; ++i ) {
+            b.Set( i );
+        }
+        b.Set( 0xFFFFFFF0 );
+        b.Optimize();
+
+        Serializer s( MB( 1 ), serializeMode_t::STORE );
+        assert( b.Serialize( &s ) );
+        assert( s.Status() == serializeStatus_t::OK );
+
+        const uint32_t size = s.CurrentSize();
+        s.SetPosition( 0 );
+        s.SetMode( serializeMode_t::LOAD );
+
+        SparseBitArray loaded;
+        assert( loaded.Serialize( &s ) );
+        assert( s.CurrentSize() == size );
+        assert( loaded.Count() == b.Count() );
+
+        SparseBitArray::Iterator it = loaded.begin();
+        for ( const uint32_t value : b )
+        {
+            assert( *it == value );
+            ++it;
+        }
+        assert( it == loaded.end() );
+    }
+
+    // --- Malformed loads are rejected ---
+    {
+        // Each case writes one container: key, type, cardinality, payload count, payload
+        struct malformed_t
+        {
+            uint8_t					type;
+            uint32_t				cardinality;
+            std::vector<uint16_t>	values;
+            uint32_t				wordCount;
+        };
+
+        const malformed_t cases[] = {
+            { 0, 0, {}, 0 },						// Empty container
+            { 1, 1, {}, 3 },						// Short bitmap
+            { 1, 5, {}, SparseBitArray::BitmapWordCount },	// Bitmap cardinality doesn't match its bits
+            { 0, 3, { 1, 2 }, 0 },					// Array cardinality doesn't match its length
+            { 0, 3, { 1, 5, 5 }, 0 },				// Array not strictly increasing
+            { 2, 2, { 10, 1, 5 }, 0 },				// Odd run payload
+            { 2, 6, { 10, 3, 12, 1 }, 0 },			// Overlapping runs
+            { 2, 2, { 65535, 1 }, 0 },				// Run past the end of the chunk
+            { 2, 4, { 10, 1 }, 0 },					// Run cardinality doesn't match
+        };
+
+        for ( const malformed_t& malformed : cases )
+        {
+            Serializer s( KB( 64 ), serializeMode_t::STORE );
+            uint32_t containerCount = 1;
+            uint16_t key = 0;
+            uint8_t type = malformed.type;
+            uint32_t cardinality = malformed.cardinality;
+            uint32_t payloadCount = ( type == 1 ) ? malformed.wordCount : static_cast<uint32_t>( malformed.values.size() );
+            s.Next( containerCount );
+            s.Next( key );
+            s.Next( type );
+            s.Next( cardinality );
+            s.Next( payloadCount );
+            if ( type == 1 )
+            {
+                std::vector<uint64_t> words( malformed.wordCount, 0 );
+                if ( !words.empty() ) {
+                    words[ 0 ] = 1;
+                }
+                SerializeArray( &s, words.data(), payloadCount );
+            }
+            else
+            {
+                std::vector<uint16_t> values = malformed.values;
+                SerializeArray( &s, values.data(), payloadCount );
+            }
+
+            s.SetPosition( 0 );
+            s.SetMode( serializeMode_t::LOAD );
+
+            SparseBitArray loaded;
+            loaded.Set( 42 );
+            assert( !loaded.Serialize( &s ) );
+            assert( loaded.NoneSet() );
+            assert( !loaded.IsSet( 63 ) );
+        }
+
+        // Keys out of order
+        SparseBitArray b;
+        b.Set( 5 );
+        b.Set( 0x20000 );
+        Serializer s( KB( 4 ), serializeMode_t::STORE );
+        assert( b.Serialize( &s ) );
+        s.SetPosition( 4 );
+        uint16_t key = 3;
+        s.Next( key );
+        s.SetPosition( 0 );
+        s.SetMode( serializeMode_t::LOAD );
+        SparseBitArray loaded;
+        assert( !loaded.Serialize( &s ) );
+        assert( loaded.NoneSet() );
+    }
+}
+}
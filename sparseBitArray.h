@@ -0,0 +1,133 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <vector>
+
+#include "common.h"
+#include "memTracker.h"
+
+class Serializer;
+
+namespace SysCore
+{
+void TestSparseBitArray();
+
+// Compressed bitmap over the full 32-bit range (roaring layout). Values are
+// bucketed by their high 16 bits into 64K-bit chunks, and each chunk picks the
+// cheapest of a sorted array, a dense bitmap or a run list. Memory follows
+// the number of set bits rather than the highest set index.
+class SparseBitArray
+{
+private:
+
+	enum class containerType_t : uint8_t
+	{
+		ARRAY,
+		BITMAP,
+		RUN,
+	};
+
+	template<class T>
+	using storage_t = std::vector<T, TaggedAllocator<T, memTag_t::BIT_ARRAY>>;
+
+	struct container_t
+	{
+		containerType_t			type = containerType_t::ARRAY;
+		uint32_t				cardinality = 0;
+		storage_t<uint16_t>		values;	// Sorted values (ARRAY) or ( start, length - 1 ) pairs (RUN)
+		storage_t<uint64_t>		words;	// BITMAP only
+
+		bool		Contains( const uint16_t low ) const;
+		bool		Add( const uint16_t low );
+		bool		Remove( const uint16_t low );
+		uint32_t	RunCount() const;
+		bool		IsValid() const;
+		void		OrInto( uint64_t* outWords ) const;
+		void		FromWords( const uint64_t* inWords );
+		void		Expand();
+		void		Optimize();
+
+		static container_t	Union( const container_t& a, const container_t& b );
+		static container_t	Intersect( const container_t& a, const container_t& b );
+	};
+
+	storage_t<uint16_t>			keys;
+	storage_t<container_t>		containers;
+
+	int32_t		FindContainer( const uint16_t key ) const;
+
+public:
+
+	static constexpr uint32_t ChunkBits = 65536;
+	static constexpr uint32_t ArrayMaxCardinality = 4096;
+	static constexpr uint32_t BitmapWordCount = ChunkBits / 64;
+
+	class Iterator
+	{
+	private:
+		const SparseBitArray*	owner;
+		uint32_t				containerIx;
+		uint32_t				cursor;
+		uint32_t				low;
+
+		void		Seek();
+	public:
+		Iterator( const SparseBitArray* _owner, const uint32_t _containerIx );
+
+		uint32_t	operator*() const;
+		Iterator&	operator++();
+
+		bool operator==( const Iterator& rhs ) const {
+			return ( containerIx == rhs.containerIx ) && ( cursor == rhs.cursor ) && ( low == rhs.low );
+		}
+
+		bool operator!=( const Iterator& rhs ) const {
+			return !( *this == rhs );
+		}
+	};
+
+	void			Reset();
+
+	void			Set( const uint32_t element );
+
+	void			Clear( const uint32_t element );
+
+	[[nodiscard]]
+	uint32_t		Count() const;
+
+	[[nodiscard]]
+	bool			AnySet() const;
+
+	[[nodiscard]]
+	bool			NoneSet() const;
+
+	[[nodiscard]]
+	bool			IsSet( const uint32_t element ) const;
+
+	// Re-encodes every chunk with its smallest representation, including runs
+	void			Optimize();
+
+	[[nodiscard]]
+	size_t			MemoryUsage() const;
+
+	// Stores or loads depending on the serializer mode. Returns false on a malformed load
+	bool			Serialize( Serializer* s );
+
+	SparseBitArray&	operator|=( const SparseBitArray& rhs );
+	SparseBitArray&	operator&=( const SparseBitArray& rhs );
+
+	SparseBitArray	operator|( const SparseBitArray& rhs ) const;
+	SparseBitArray	operator&( const SparseBitArray& rhs ) const;
+
+	Iterator		begin() const
+	{
+		return Iterator( this, 0 );
+	}
+
+	Iterator		end() const
+	{
+		return Iterator( this, static_cast<uint32_t>( containers.size() ) );
+	}
+};
+}
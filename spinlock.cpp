@@ -0,0 +1,180 @@
+#include "spinlock.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "timer.h"
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#pragma comment( lib, "Synchronization.lib" )
+#elif defined( __linux__ )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+void AtomicWait( const std::atomic<uint32_t>* address, const uint32_t expected )
+{
+#if defined( _WIN32 )
+	uint32_t compare = expected;
+	WaitOnAddress( const_cast<std::atomic<uint32_t>*>( address ), &compare, sizeof( compare ), INFINITE );
+#elif defined( __linux__ )
+	syscall( SYS_futex, reinterpret_cast<const uint32_t*>( address ), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0 );
+#else
+	if ( address->load( std::memory_order_relaxed ) == expected ) {
+		std::this_thread::yield();
+	}
+#endif
+}
+
+
+void AtomicWakeOne( std::atomic<uint32_t>* address )
+{
+#if defined( _WIN32 )
+	WakeByAddressSingle( address );
+#elif defined( __linux__ )
+	syscall( SYS_futex, reinterpret_cast<uint32_t*>( address ), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0 );
+#else
+	( void )address;
+#endif
+}
+
+
+void AtomicWakeAll( std::atomic<uint32_t>* address )
+{
+#if defined( _WIN32 )
+	WakeByAddressAll( address );
+#elif defined( __linux__ )
+	syscall( SYS_futex, reinterpret_cast<uint32_t*>( address ), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0 );
+#else
+	( void )address;
+#endif
+}
+
+
+void SpinLock::LockContended()
+{
+	// Spin only reading the word so waiters don't bounce the cache line
+	SpinBackoff backoff;
+	while ( backoff.Spin() )
+	{
+		if ( ( state.load( std::memory_order_relaxed ) == UNLOCKED ) && TryAcquire() ) {
+			return;
+		}
+	}
+
+	// Take the lock marked as having sleepers. That may cause one spare wake
+	// later, but never a missed one
+	while ( state.exchange( SLEEPERS, std::memory_order_acquire ) != UNLOCKED ) {
+		AtomicWait( &state, SLEEPERS );
+	}
+}
+
+
+void TestSpinLock()
+{
+    // --- TryLock and the guard ---
+    {
+        SpinLock lock;
+        assert( !lock.IsLocked() );
+        assert( lock.TryLock() );
+        assert( lock.IsLocked() );
+        assert( !lock.TryLock() );
+        lock.Unlock();
+        assert( !lock.IsLocked() );
+        {
+            SpinLockGuard guard( lock );
+            assert( lock.IsLocked() );
+        }
+        assert( lock.TryLock() );
+        lock.Unlock();
+    }
+
+    // --- Mutual exclusion under contention, long holds force the OS wait ---
+    {
+        SpinLock lock;
+        uint64_t counter = 0;
+        const uint32_t threadCount = 4;
+        const uint32_t iterations = 20000;
+
+        std::vector<std::thread> threads;
+        for ( uint32_t t = 0; t < threadCount; ++t )
+        {
+            threads.emplace_back( [&, t]() {
+                for ( uint32_t i = 0; i < iterations; ++i )
+                {
+                    SpinLockGuard guard( lock );
+                    const uint64_t value = counter;
+                    if ( ( i % 1000 ) == t ) {
+                        std::this_thread::yield();
+                    }
+                    counter = value + 1;
+                }
+            } );
+        }
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+        assert( counter == threadCount * iterations );
+        assert( !lock.IsLocked() );
+    }
+}
+
+
+template<class LockType>
+static uint64_t BenchmarkLock( LockType& lock, const uint32_t threadCount, const uint32_t iterations )
+{
+    uint64_t counter = 0;
+
+    SysCore::Timer timer( "SpinLock", SysCore::timerPrecision_t::MICROSECOND );
+    std::vector<std::thread> threads;
+    for ( uint32_t t = 0; t < threadCount; ++t )
+    {
+        threads.emplace_back( [&]() {
+            for ( uint32_t i = 0; i < iterations; ++i )
+            {
+                lock.lock();
+                ++counter;
+                lock.unlock();
+            }
+        } );
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+    timer.Stop();
+
+    assert( counter == static_cast<uint64_t>( threadCount ) * iterations );
+    return std::max<uint64_t>( 1, timer.GetElapsed() );
+}
+
+
+void BenchmarkSpinLock()
+{
+    struct spinLockAdapter_t
+    {
+        SpinLock spinLock;
+        void lock() { spinLock.Lock(); }
+        void unlock() { spinLock.Unlock(); }
+    };
+
+    const uint32_t iterations = 1 << 20;
+    const uint32_t maxThreads = std::max( 2u, std::thread::hardware_concurrency() );
+
+    for ( uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2 )
+    {
+        spinLockAdapter_t spinLock;
+        std::mutex mutex;
+        const uint64_t spinUs = BenchmarkLock( spinLock, threadCount, iterations );
+        const uint64_t mutexUs = BenchmarkLock( mutex, threadCount, iterations );
+
+        const uint64_t totalOps = static_cast<uint64_t>( threadCount ) * iterations;
+        std::cout << "SpinLock " << threadCount << " threads: " << ( totalOps / spinUs ) << "M lock/unlock/s, std::mutex "
+            << ( totalOps / mutexUs ) << "M lock/unlock/s" << std::endl;
+    }
+}
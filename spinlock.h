@@ -1,26 +1,170 @@
 #pragma once
 #include <atomic>
-#include <chrono>
+#include <cstdint>
 #include <thread>
 
+#ifdef SYSCORE_LOCK_PROFILING
+#include "lockProfiler.h"
+#endif
+
+#if defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#define SPINLOCK_HAS_PAUSE
+#endif
+
+void TestSpinLock();
+void BenchmarkSpinLock();
+
+// Tells the core we're spinning, frees pipeline resources for a sibling hyperthread
+inline void CpuPause()
+{
+#ifdef SPINLOCK_HAS_PAUSE
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+// Exponential pause backoff for spin-then-sleep waits. Each Spin() pauses for
+// twice as long as the one before, up to MaxPauses, and once SpinRounds bursts
+// have run it returns false without pausing so the caller can sleep instead
+class SpinBackoff
+{
+public:
+	static const uint32_t MaxPauses = 64;
+	static const uint32_t SpinRounds = 10;
+
+	inline bool Spin()
+	{
+		if ( round >= SpinRounds ) {
+			return false;
+		}
+		++round;
+		for ( uint32_t i = 0; i < pauses; ++i ) {
+			CpuPause();
+		}
+		pauses = ( pauses < MaxPauses ) ? ( 2 * pauses ) : MaxPauses;
+		return true;
+	}
+
+	// Starts over from a single pause, e.g. after the wait made progress
+	inline void Reset()
+	{
+		pauses = 1;
+		round = 0;
+	}
+
+private:
+	uint32_t	pauses = 1;
+	uint32_t	round = 0;
+};
+
+// Blocks while *address == expected (futex on Linux, WaitOnAddress on Windows,
+// yield elsewhere). May return spuriously, callers re-check their condition
+void AtomicWait( const std::atomic<uint32_t>* address, const uint32_t expected );
+void AtomicWakeOne( std::atomic<uint32_t>* address );
+void AtomicWakeAll( std::atomic<uint32_t>* address );
+
+// Adaptive lock. Uncontended Lock()/Unlock() are a single atomic each. A waiter
+// spins read-only on the lock word (test-and-test-and-set) with exponentially
+// growing pause bursts, and after a bounded number of rounds sleeps in the OS
+// until the holder wakes it. The lock word records whether anyone may be asleep
+// so Unlock() only makes the wake syscall when needed. The name is only used
+// when SYSCORE_LOCK_PROFILING is defined.
 class SpinLock
 {
 public:
-	SpinLock() {
-		lock.store( false );
+	SpinLock( const char* name = nullptr ) {
+		state.store( UNLOCKED, std::memory_order_relaxed );
+#ifdef SYSCORE_LOCK_PROFILING
+		profileId = LockProfileRegister( name );
+		holdStart = 0;
+#else
+		(void)name;
+#endif
 	}
 
+	SpinLock( const SpinLock& ) = delete;
+	SpinLock& operator=( const SpinLock& ) = delete;
+
 	void Lock() {
-		bool expected = false;
-		while ( lock.compare_exchange_strong( expected, true ) == false ) {
-			std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+#ifdef SYSCORE_LOCK_PROFILING
+		const bool contended = ( TryAcquire() == false );
+		const uint64_t waitStart = contended ? LockProfileNow() : 0;
+		if ( contended ) {
+			LockContended();
+		}
+		holdStart = LockProfileNow();
+		LockProfileAcquired( profileId, contended, contended ? ( holdStart - waitStart ) : 0 );
+#else
+		if ( TryAcquire() == false ) {
+			LockContended();
 		}
+#endif
 	}
+
+	[[nodiscard]]
+	bool TryLock() {
+#ifdef SYSCORE_LOCK_PROFILING
+		if ( TryAcquire() == false ) {
+			return false;
+		}
+		LockProfileAcquired( profileId, false, 0 );
+		holdStart = LockProfileNow();
+		return true;
+#else
+		return TryAcquire();
+#endif
+	}
+
 	void Unlock() {
-		if ( lock.load() ) {
-			lock.store( false );
+#ifdef SYSCORE_LOCK_PROFILING
+		LockProfileReleased( profileId, LockProfileNow() - holdStart );
+#endif
+		if ( state.exchange( UNLOCKED, std::memory_order_release ) == SLEEPERS ) {
+			AtomicWakeOne( &state );
 		}
 	}
+
+	bool IsLocked() const {
+		return ( state.load( std::memory_order_relaxed ) != UNLOCKED );
+	}
+private:
+	enum : uint32_t
+	{
+		UNLOCKED,
+		LOCKED,
+		SLEEPERS,	// Locked, and a waiter may be in AtomicWait()
+	};
+
+	inline bool TryAcquire() {
+		uint32_t expected = UNLOCKED;
+		return ( state.load( std::memory_order_relaxed ) == UNLOCKED ) &&
+			state.compare_exchange_strong( expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed );
+	}
+
+	void LockContended();
+
+	std::atomic<uint32_t> state;
+#ifdef SYSCORE_LOCK_PROFILING
+	uint32_t profileId;
+	uint64_t holdStart;		// Only touched by the holder
+#endif
+};
+
+class SpinLockGuard
+{
+public:
+	SpinLockGuard( SpinLock& _lock ) : lock( _lock ) {
+		lock.Lock();
+	}
+
+	~SpinLockGuard() {
+		lock.Unlock();
+	}
+
+	SpinLockGuard( const SpinLockGuard& ) = delete;
+	SpinLockGuard& operator=( const SpinLockGuard& ) = delete;
 private:
-	std::atomic<bool> lock;
-};
\ No newline at end of file
+	SpinLock& lock;
+};
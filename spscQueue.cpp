@@ -0,0 +1,182 @@
+#include "spscQueue.h"
+
+#include <assert.h>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "timer.h"
+
+namespace SysCore
+{
+void TestSpscQueue()
+{
+    // --- Single thread push/pop and wrap around ---
+    {
+        SpscQueue<uint32_t, 8> q;
+        assert( q.IsEmpty() );
+        assert( q.Capacity() == 8 );
+
+        uint32_t value = 0;
+        assert( !q.TryPop( value ) );
+
+        for ( uint32_t i = 0; i < 8; ++i ) {
+            assert( q.TryPush( i ) );
+        }
+        assert( !q.TryPush( 99u ) );
+        assert( q.Count() == 8 );
+
+        for ( uint32_t i = 0; i < 5; ++i )
+        {
+            assert( q.TryPop( value ) );
+            assert( value == i );
+        }
+
+        // Block spans the end of the buffer
+        const uint32_t src[] = { 100, 101, 102, 103, 104, 105 };
+        assert( q.PushN( src, COUNTARRAY( src ) ) == 5 );
+
+        uint32_t dst[ 16 ] = {};
+        assert( q.PopN( dst, 16 ) == 8 );
+        assert( dst[ 0 ] == 5 && dst[ 2 ] == 7 );
+        assert( dst[ 3 ] == 100 && dst[ 7 ] == 104 );
+        assert( q.IsEmpty() );
+        assert( q.PopN( dst, 16 ) == 0 );
+    }
+
+    // --- Move-only payloads ---
+    {
+        SpscQueue<std::unique_ptr<uint32_t>, 4> q;
+        assert( q.TryPush( std::make_unique<uint32_t>( 7 ) ) );
+        std::unique_ptr<uint32_t> out;
+        assert( q.TryPop( out ) );
+        assert( *out == 7 );
+    }
+
+    // --- Two threads, ordering is preserved ---
+    {
+        static SpscQueue<uint32_t, 1024> q;
+        const uint32_t total = 1000000;
+
+        std::thread producer( [&]() {
+            uint32_t block[ 64 ];
+            uint32_t next = 0;
+            while ( next < total )
+            {
+                const uint32_t blockCount = std::min<uint32_t>( 64, total - next );
+                for ( uint32_t i = 0; i < blockCount; ++i ) {
+                    block[ i ] = next + i;
+                }
+                uint32_t pushed = 0;
+                while ( pushed < blockCount )
+                {
+                    const uint32_t count = q.PushN( block + pushed, blockCount - pushed );
+                    if ( count == 0 ) {
+                        std::this_thread::yield();
+                    }
+                    pushed += count;
+                }
+                next += blockCount;
+            }
+        } );
+
+        uint32_t expected = 0;
+        uint32_t block[ 100 ];
+        while ( expected < total )
+        {
+            const uint32_t popped = q.PopN( block, 100 );
+            if ( popped == 0 ) {
+                std::this_thread::yield();
+            }
+            for ( uint32_t i = 0; i < popped; ++i )
+            {
+                assert( block[ i ] == expected );
+                ++expected;
+            }
+        }
+        producer.join();
+        assert( q.IsEmpty() );
+    }
+}
+
+
+void BenchmarkSpscQueue()
+{
+    // --- Latency: round trip through a pair of queues ---
+    {
+        static SpscQueue<uint64_t, 64> ping;
+        static SpscQueue<uint64_t, 64> pong;
+        const uint32_t roundTrips = 200000;
+
+        std::thread echo( [&]() {
+            uint64_t value = 0;
+            for ( uint32_t i = 0; i < roundTrips; ++i )
+            {
+                while ( !ping.TryPop( value ) ) {
+                    std::this_thread::yield();
+                }
+                while ( !pong.TryPush( value ) ) {
+                    std::this_thread::yield();
+                }
+            }
+        } );
+
+        Timer timer( "SpscQueue round trip", timerPrecision_t::NANOSECOND );
+        uint64_t value = 0;
+        for ( uint32_t i = 0; i < roundTrips; ++i )
+        {
+            while ( !ping.TryPush( uint64_t( i ) ) ) {
+                std::this_thread::yield();
+            }
+            while ( !pong.TryPop( value ) ) {
+                std::this_thread::yield();
+            }
+        }
+        timer.Stop();
+        echo.join();
+
+        std::cout << "SpscQueue latency: " << ( timer.GetElapsed() / roundTrips ) << "ns per round trip" << std::endl;
+    }
+
+    // --- Throughput: per element vs block transfers ---
+    const uint32_t total = 1 << 24;
+    const uint32_t blockSizes[] = { 1, 64, 512 };
+    for ( uint32_t blockIx = 0; blockIx < COUNTARRAY( blockSizes ); ++blockIx )
+    {
+        static SpscQueue<float, 4096> q;
+        const uint32_t blockSize = blockSizes[ blockIx ];
+
+        Timer timer( "SpscQueue throughput", timerPrecision_t::MICROSECOND );
+
+        std::thread producer( [&]() {
+            float block[ 512 ] = {};
+            uint32_t sent = 0;
+            while ( sent < total )
+            {
+                const uint32_t count = std::min( blockSize, total - sent );
+                const uint32_t pushed = ( count == 1 ) ? ( q.TryPush( block[ 0 ] ) ? 1 : 0 ) : q.PushN( block, count );
+                if ( pushed == 0 ) {
+                    std::this_thread::yield();
+                }
+                sent += pushed;
+            }
+        } );
+
+        float block[ 512 ];
+        uint32_t received = 0;
+        while ( received < total )
+        {
+            const uint32_t popped = ( blockSize == 1 ) ? ( q.TryPop( block[ 0 ] ) ? 1 : 0 ) : q.PopN( block, blockSize );
+            if ( popped == 0 ) {
+                std::this_thread::yield();
+            }
+            received += popped;
+        }
+        producer.join();
+        timer.Stop();
+
+        const uint64_t elapsedUs = std::max<uint64_t>( 1, timer.GetElapsed() );
+        std::cout << "SpscQueue throughput (block " << blockSize << "): " << ( static_cast<uint64_t>( total ) / elapsedUs ) << "M elements/s" << std::endl;
+    }
+}
+}
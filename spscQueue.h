@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "common.h"
+
+namespace SysCore
+{
+void TestSpscQueue();
+void BenchmarkSpscQueue();
+
+// Lock-free ring buffer for exactly one producer thread and one consumer thread.
+// Indices run freely and are masked on access, so N must be a power of two.
+// Each side keeps a cached copy of the other's index and only reloads it
+// when the cached value says the queue is full/empty.
+template<class T, uint32_t N>
+class SpscQueue
+{
+private:
+	static_assert( ( N > 0 ) && ( ( N & ( N - 1 ) ) == 0 ), "SpscQueue capacity must be a power of two" );
+
+	static constexpr uint32_t Mask = N - 1;
+
+	// Consumer owned
+	alignas( CACHE_LINE_SIZE ) std::atomic<uint32_t>	head;
+	uint32_t											cachedTail;
+
+	// Producer owned
+	alignas( CACHE_LINE_SIZE ) std::atomic<uint32_t>	tail;
+	uint32_t											cachedHead;
+
+	alignas( CACHE_LINE_SIZE ) T						buffer[ N ];
+
+	inline uint32_t WritableCount( const uint32_t writeIx )
+	{
+		uint32_t freeCount = N - ( writeIx - cachedHead );
+		if ( freeCount == 0 )
+		{
+			cachedHead = head.load( std::memory_order_acquire );
+			freeCount = N - ( writeIx - cachedHead );
+		}
+		return freeCount;
+	}
+
+	inline uint32_t ReadableCount( const uint32_t readIx )
+	{
+		uint32_t usedCount = cachedTail - readIx;
+		if ( usedCount == 0 )
+		{
+			cachedTail = tail.load( std::memory_order_acquire );
+			usedCount = cachedTail - readIx;
+		}
+		return usedCount;
+	}
+
+public:
+
+	SpscQueue() : head( 0 ), cachedTail( 0 ), tail( 0 ), cachedHead( 0 )
+	{}
+
+	SpscQueue( const SpscQueue& ) = delete;
+	SpscQueue& operator=( const SpscQueue& ) = delete;
+
+	// Producer thread only
+	template<typename U>
+	inline bool TryPush( U&& element )
+	{
+		const uint32_t writeIx = tail.load( std::memory_order_relaxed );
+		if ( WritableCount( writeIx ) == 0 ) {
+			return false;
+		}
+
+		buffer[ writeIx & Mask ] = std::forward<U>( element );
+		tail.store( writeIx + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Producer thread only. Copies up to elementCount elements in at most two
+	// contiguous blocks and publishes them with a single store
+	inline uint32_t PushN( const T* src, const uint32_t elementCount )
+	{
+		const uint32_t writeIx = tail.load( std::memory_order_relaxed );
+
+		uint32_t freeCount = N - ( writeIx - cachedHead );
+		if ( freeCount < elementCount )
+		{
+			cachedHead = head.load( std::memory_order_acquire );
+			freeCount = N - ( writeIx - cachedHead );
+		}
+
+		const uint32_t pushCount = std::min( freeCount, elementCount );
+		const uint32_t first = writeIx & Mask;
+		const uint32_t firstCount = std::min( pushCount, N - first );
+
+		std::copy( src, src + firstCount, buffer + first );
+		std::copy( src + firstCount, src + pushCount, buffer );
+
+		tail.store( writeIx + pushCount, std::memory_order_release );
+		return pushCount;
+	}
+
+	// Consumer thread only
+	inline bool TryPop( T& outElement )
+	{
+		const uint32_t readIx = head.load( std::memory_order_relaxed );
+		if ( ReadableCount( readIx ) == 0 ) {
+			return false;
+		}
+
+		outElement = std::move( buffer[ readIx & Mask ] );
+		head.store( readIx + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Consumer thread only. Mirror of PushN()
+	inline uint32_t PopN( T* dst, const uint32_t maxCount )
+	{
+		const uint32_t readIx = head.load( std::memory_order_relaxed );
+
+		uint32_t usedCount = cachedTail - readIx;
+		if ( usedCount < maxCount )
+		{
+			cachedTail = tail.load( std::memory_order_acquire );
+			usedCount = cachedTail - readIx;
+		}
+
+		const uint32_t popCount = std::min( usedCount, maxCount );
+		const uint32_t first = readIx & Mask;
+		const uint32_t firstCount = std::min( popCount, N - first );
+
+		std::move( buffer + first, buffer + first + firstCount, dst );
+		std::move( buffer, buffer + ( popCount - firstCount ), dst + firstCount );
+
+		head.store( readIx + popCount, std::memory_order_release );
+		return popCount;
+	}
+
+	// Approximate when called while the other side is active
+	inline uint32_t Count() const
+	{
+		const uint32_t readIx = head.load( std::memory_order_acquire );
+		return tail.load( std::memory_order_acquire ) - readIx;
+	}
+
+	inline bool IsEmpty() const
+	{
+		return ( Count() == 0 );
+	}
+
+	inline uint32_t Capacity() const
+	{
+		return N;
+	}
+};
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common.h"
+
+namespace SysCore
+{
+// One Record per thread that has used a module. Records sit on a lock-free list
+// and are never freed, so any thread can walk them without locking. When a
+// thread exits, Retire( record ) runs on it to fold the record into the module's
+// totals, then the record is handed to the next thread that asks for one.
+//
+// Only the owning thread writes its record; fields other threads read must be
+// atomics. A new record is value-initialized. The list and each thread's slot are
+// statics, so there is one registry per Record type
+template<class Record, void ( *Retire )( Record& record )>
+class ThreadRegistry
+{
+private:
+	struct alignas( CACHE_LINE_SIZE ) node_t
+	{
+		std::atomic<bool>	inUse;
+		node_t*				next;
+		Record				record;
+	};
+
+	struct owner_t
+	{
+		node_t* node = nullptr;
+
+		~owner_t()
+		{
+			if ( node != nullptr )
+			{
+				Retire( node->record );
+				node->inUse.store( false, std::memory_order_release );
+			}
+		}
+	};
+
+	static std::atomic<node_t*>& Head()
+	{
+		static std::atomic<node_t*> head{ nullptr };
+		return head;
+	}
+
+	static node_t* Acquire()
+	{
+		std::atomic<node_t*>& head = Head();
+
+		for ( node_t* node = head.load( std::memory_order_acquire ); node != nullptr; node = node->next )
+		{
+			bool expected = false;
+			if ( ( node->inUse.load( std::memory_order_relaxed ) == false ) &&
+				node->inUse.compare_exchange_strong( expected, true, std::memory_order_acquire ) ) {
+				return node;
+			}
+		}
+
+		node_t* node = new node_t();
+		node->inUse.store( true, std::memory_order_relaxed );
+		node->next = head.load( std::memory_order_relaxed );
+		while ( !head.compare_exchange_weak( node->next, node, std::memory_order_release, std::memory_order_relaxed ) ) {
+		}
+		return node;
+	}
+
+public:
+	// The calling thread's record, claimed on first use
+	static inline Record& Local()
+	{
+		static thread_local owner_t owner;
+		if ( owner.node == nullptr ) {
+			owner.node = Acquire();
+		}
+		return owner.node->record;
+	}
+
+	// Visits every record, including ones no thread currently owns
+	template<typename F>
+	static void ForEach( F&& func )
+	{
+		for ( node_t* node = Head().load( std::memory_order_acquire ); node != nullptr; node = node->next ) {
+			func( node->record );
+		}
+	}
+};
+}
@@ -59,6 +59,13 @@ public:
 };
 
 
+// Steady clock in nanoseconds, for timing intervals
+inline uint64_t MonotonicNowNs()
+{
+	return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+}
+
+
 typedef void( *scopedTimerLogCallback_t )( const Timer* );
 
 class ScopedLogTimer : public Timer